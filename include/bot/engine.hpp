@@ -1,8 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
 #include <thread>
 
+#include "bot/move_picker.hpp"
+#include "bot/nnue.hpp"
 #include "bot/opening_book.hpp"
+#include "bot/pawn_hash_table.hpp"
 #include "bot/transposition_table.hpp"
 #include "core/board.hpp"
 #include "utils/utils.hpp"
@@ -17,28 +24,12 @@ namespace TungstenChess
 {
   enum EvaluationConstants : int
   {
-    BISHOP_PAIR_BONUS = 100,
-    CASTLED_KING_BONUS = 25,
-    CAN_CASTLE_BONUS = 25,
-    ROOK_ON_OPEN_FILE_BONUS = 50,
-    ROOK_ON_SEMI_OPEN_FILE_BONUS = 25,
-    KNIGHT_OUTPOST_BONUS = 50,
-    PASSED_PAWN_BONUS = 50,
-    DOUBLED_PAWN_PENALTY = 50,
-    ISOLATED_PAWN_PENALTY = 25,
-    BACKWARDS_PAWN_PENALTY = 50,
-    KING_SAFETY_PAWN_SHIELD_PER_PAWN_BONUS = 20,
     CONTEMPT = 0,
   };
 
   class Bot
   {
-  private:
-    Board& m_board;
-    OpeningBook m_openingBook;
-
-    MoveStack m_moveStack;
-
+  public:
     struct BotSettings
     {
       int maxSearchTime = 2000; // in milliseconds
@@ -46,23 +37,87 @@ namespace TungstenChess
       bool useOpeningBook = DEF_USE_OPENING_BOOK;
       bool logSearchInfo = true;
       bool logPGNMoves = true;
+      bool logUCIInfo = false;         // Print a UCI info line after every completed iteration of the search
       int transpositionTableSizeMB = 128;
-      int maxHeuristicSortedMoves = 4; // Maximum number of moves to sort by heuristic evaluation (too few leads to poor pruning, too many leads to unnecessary sorting)
+      int searchThreads = 1;           // Number of threads searching in parallel (Lazy SMP), including the main search thread
+      int aspirationWindow = 50;       // Initial half-width of the aspiration window around the previous iteration's evaluation
+      bool useNNUE = true;             // Evaluate with the NNUE if a network is loaded, otherwise the handcrafted evaluation is used
+      int moveOverhead = 30;           // Time in milliseconds kept in reserve for communication when playing on a clock
+      int reverseFutilityMargin = 75;  // Margin per ply of depth above beta for reverse futility pruning
+      int futilityMargin = 100;        // Margin per ply of depth below alpha for futility pruning of quiet moves
+      int razoringMargin = 250;        // Margin per ply of depth below alpha for razoring into quiescence search
+    };
+
+    /**
+     * @brief The limits of a single search. Any combination may be set, the search stops at whichever is reached first,
+     *        and with no limits at all it runs until stopSearch is called
+     */
+    struct SearchLimits
+    {
+      int maxSearchTime = -1; // in milliseconds, -1 for no fixed time
+      int maxDepth = -1;      // -1 for no depth limit
+      uint64_t maxNodes = 0;  // 0 for no node limit
+
+      int timeLeft = -1; // Time left on the clock for the side to move in milliseconds, -1 if not playing on a clock
+      int increment = 0; // Increment per move in milliseconds
+      int movesToGo = 0; // Moves until the next time control, 0 if the remaining time is for the rest of the game
     };
 
-    const BotSettings m_botSettings;
+  private:
+    Board& m_board;
+    OpeningBook m_openingBook;
+
+    MoveStack m_moveStack;
+
+    BotSettings m_botSettings;
+
+    SearchLimits m_searchLimits;
 
-    TranspositionTable m_transpositionTable;
+    std::shared_ptr<TranspositionTable> m_transpositionTable; // Shared with helper bots during Lazy SMP search
 
     static constexpr inline int CASTLING_BONUS_MULTIPLIERS[16] = { 0, 1, 1, 2, 0, -1, 1, 0, 0, 1, -1, 0, 0, -1, -1, -2 };
 
     static const int MATERIAL_DIMINISH_SHIFT = 14;
 
+    static const int ASPIRATION_MIN_DEPTH = 4;
+
+    static const int NULL_MOVE_MIN_DEPTH = 3;
+    static const int NULL_MOVE_REDUCTION = 3;                // Base depth reduction of the null move search
+    static const int NULL_MOVE_REDUCTION_DEPTH_DIVISOR = 6;  // The reduction grows by one for every this many plies of depth
+    static const int NULL_MOVE_VERIFICATION_MIN_DEPTH = 10;  // Null move cutoffs at this depth or more are verified
+
+    static const int MAX_SEARCH_DEPTH = 100; // Keeps depths within the range stored by the transposition table
+
+    static const int LMR_MIN_DEPTH = 3;
+    static const int LMR_FULL_DEPTH_MOVES = 3;   // Moves searched before late move reductions apply
+    static const int LMR_HISTORY_DIVISOR = 8192; // Reductions change by one ply per this much history score
+
+    static const int REVERSE_FUTILITY_MAX_DEPTH = 6;
+    static const int FUTILITY_MAX_DEPTH = 3;
+    static const int RAZORING_MAX_DEPTH = 2;
+
+    static const int SINGULAR_EXTENSION_MIN_DEPTH = 6;
+    static const int SINGULAR_EXTENSION_DEPTH_MARGIN = 3; // The hash entry may be this much shallower than the node
+    static const int SINGULAR_EXTENSION_MARGIN = 2;       // Margin per ply of depth below the hash move's evaluation
+
+    static const int MAX_PATH_EXTENSIONS = 16; // Extensions allowed along a single line of the search, to stop search explosions
+
+    static const int IIR_MIN_DEPTH = 4; // Nodes without a hash move are searched one ply shallower from this depth
+
+    static const int MAX_FAILED_QUIETS = 64; // Quiet moves penalized in the history table per beta cutoff
+
+    // Late move reductions indexed by [depth][number of moves already searched], see initLateMoveReductions
+    static inline std::array<std::array<uint8_t, MAX_LEGAL_MOVE_COUNT>, MAX_SEARCH_DEPTH + 1> s_lateMoveReductions = {};
+
+    static const int DEFAULT_MOVES_TO_GO = 30;     // Assumed number of remaining moves when the clock has no moves to go
+    static const int NODE_LIMIT_CHECK_MASK = 1023; // The node limit is checked every 1024 nodes
+
     struct SearchInfo
     {
       int positionsEvaluated;
       int transpositionsUsed;
       int depthSearched;
+      int selectiveDepth;
 
       int nextDepthNumMovesSearched;
       int nextDepthTotalMoves;
@@ -72,11 +127,14 @@ namespace TungstenChess
       int mateIn;
       bool lossFound;
 
+      Move bestMove;
+
       void reset()
       {
         positionsEvaluated = 0;
         transpositionsUsed = 0;
         depthSearched = 0;
+        selectiveDepth = 0;
 
         nextDepthNumMovesSearched = 0;
         nextDepthTotalMoves = 0;
@@ -85,13 +143,46 @@ namespace TungstenChess
         mateFound = false;
         mateIn = 0;
         lossFound = false;
+
+        bestMove = NULL_MOVE;
       }
     };
 
     SearchInfo m_previousSearchInfo;
-    uint m_currentSearchId = 0;
 
-    std::atomic<bool> m_searchCancelled = false;
+    // Lazy SMP helpers - each helper bot searches its own branch of the board and shares the transposition table. They are
+    // created when the number of search threads is set and kept between searches, along with their history and pawn hash table
+    std::vector<std::unique_ptr<Board>> m_helperBoards;
+    std::vector<std::unique_ptr<Bot>> m_helperBots;
+    std::vector<std::thread> m_helperThreads;
+
+    std::atomic<uint64_t> m_nodesSearched = 0; // Only written by the searching thread, read by the main bot for limits and UCI info
+    int m_searchPly = 0;
+
+    MoveHistory m_moveHistory; // Owned by each search thread
+    PawnHashTable m_pawnHashTable; // Owned by each search thread
+
+    static const int MATE_THRESHOLD = INF_EVAL - 1000; // Evaluations beyond this are mate scores, INF_EVAL - plies to mate
+
+    static const int NO_EVALUATION = -INF_EVAL - 1; // Static evaluation of positions in check, which is never computed
+
+    /**
+     * @brief Information about a ply of the line currently being searched
+     */
+    struct SearchStackEntry
+    {
+      Move move = NULL_MOVE;                // The move played from this ply, NULL_MOVE for null moves
+      bool capture = false;                 // Whether the move played from this ply was a capture
+      int staticEvaluation = NO_EVALUATION; // The static evaluation at this ply
+      Move excludedMove = NULL_MOVE;        // The move excluded from this ply during a singular extension search
+    };
+
+    std::array<SearchStackEntry, MoveHistory::MAX_PLY> m_searchStack;
+    int m_extensionsOnPath = 0; // Plies of extensions along the line currently being searched
+    std::chrono::high_resolution_clock::time_point m_searchStartTime;
+
+    std::atomic<bool> m_searchCancelled = false; // Set by the search's own limits (timer, nodes), cleared when a search starts
+    std::atomic<bool> m_stopRequested = false;   // Set by stopSearch, only cleared by the caller through clearStopRequest
     std::atomic<int> m_maxSearchTime = 0;
     std::thread m_searchTimerThread;
     std::condition_variable m_searchTimerEvent;
@@ -120,6 +211,13 @@ namespace TungstenChess
      */
     void loadOpeningBook(const std::filesystem::path path);
 
+    /**
+     * @brief Loads the NNUE network from a file, keeping the handcrafted evaluation if the file is missing or invalid
+     * @param path The path to the network file
+     * @return Whether the network was loaded
+     */
+    bool loadNNUE(const std::filesystem::path path);
+
     /**
      * @brief Adds a move to the opening book move history
      * @param move The move to add
@@ -132,7 +230,64 @@ namespace TungstenChess
      */
     Move generateBotMove(int maxSearchTime = -1);
 
+    /**
+     * @brief Generates the best move for the bot within the given search limits
+     * @param searchLimits The limits of the search, see SearchLimits
+     */
+    Move generateBotMove(const SearchLimits& searchLimits);
+
+    /**
+     * @brief Stops the current search as soon as possible, the search then returns the best move found so far.
+     *        The request persists (so it is not lost if the search has not started yet) until clearStopRequest is called
+     * @note Safe to call from any thread
+     */
+    void stopSearch() { m_stopRequested = true; }
+
+    /**
+     * @brief Clears a previous stopSearch request, so that the next search can run
+     * @note Must not be called while a search is running
+     */
+    void clearStopRequest() { m_stopRequested = false; }
+
+    const BotSettings& botSettings() const { return m_botSettings; }
+
+    /**
+     * @brief Gets the total number of nodes searched by this bot and its helpers in the current (or last) search
+     */
+    uint64_t getNodesSearched() const;
+
+    /**
+     * @brief Replaces the bot's settings, recreating the transposition table if its size changed and the helpers if the
+     *        number of search threads changed
+     * @param settings The new settings
+     * @note Must not be called while a search is running
+     */
+    void setBotSettings(const BotSettings& settings);
+
+    /**
+     * @brief Clears the transposition table, e.g. before a new game
+     * @note Must not be called while a search is running
+     */
+    void clearTranspositionTable() { m_transpositionTable->clear(); }
+
+    /**
+     * @brief Restarts the opening book move history from the board's current position, after the board has been reset
+     */
+    void resetOpeningBook() { m_openingBook.reset(m_board.zobristKey()); }
+
   private:
+    /**
+     * @brief Constructs a helper bot for Lazy SMP search
+     * @param board The board branch the helper searches on
+     * @param mainBot The bot that owns the helper, whose settings and transposition table are shared
+     */
+    Bot(Board& board, const Bot& mainBot);
+
+    /**
+     * @brief Fills the late move reduction table, reducing by 0.75 + ln(depth) * ln(move number) / 2.25 plies
+     */
+    static void initLateMoveReductions();
+
     /**
      * @brief Starts the search timer thread
      * @note This function is called automatically by the constructor
@@ -146,36 +301,74 @@ namespace TungstenChess
     void stopSearchTimerThread();
 
     /**
-     * @brief Gets the legal moves for a color, sorted by heuristic evaluation
-     * @param moves The array to store the moves in
-     * @param onlyCaptures Whether to only get captures
-     * @param bestMove The best move found so far, used when iterative deepening has already found a good move
-     * @return The number of legal moves generated
+     * @brief Creates the searchThreads - 1 Lazy SMP helper bots (and their boards), replacing any existing ones
      */
-    int getSortedLegalMoves(MoveAllocation& moves, bool onlyCaptures = false, Move bestMove = NULL_MOVE);
+    void createHelpers();
 
     /**
-     * @brief Gets the positional evaluation of a single piece
-     * @param pieceIndex The index of the piece
-     * @param absolute Whether to return the value of the evaluation as if the piece was white (true for heuristic evaluation, false for static evaluation)
+     * @brief Starts the Lazy SMP helper threads, each searching a fresh branch of the board
+     * @note The number of helpers is searchThreads - 1, so no helpers are started for a single-threaded search
      */
-    int getPiecePositionalEvaluation(Square pieceIndex, bool absolute = false) const;
+    void startHelperThreads();
 
     /**
-     * @brief Generates the best move for the bot
+     * @brief Cancels and joins the helper threads, then merges their search info into m_previousSearchInfo
+     * @note The best move is taken from whichever thread completed the deepest iteration
+     */
+    void stopHelperThreads();
+
+    /**
+     * @brief Gets the time to search for within the given limits, allotting a share of the remaining clock time if playing on a clock
+     * @param searchLimits The limits of the search
+     * @return The time in milliseconds, or -1 if the search is not limited by time
+     */
+    int getAllottedSearchTime(const SearchLimits& searchLimits) const;
+
+    /**
+     * @brief Gets the principal variation by following the best moves stored in the transposition table
+     * @param bestMove The best move at the root
+     * @param maxLength The maximum number of moves to return
+     */
+    std::vector<Move> getPrincipalVariation(Move bestMove, int maxLength);
+
+    /**
+     * @brief Prints a UCI info line for the last completed iteration of the search
+     * @param bestMove The best move at the root
+     */
+    void logUCIInfo(Move bestMove);
+
+    /**
+     * @brief Generates the best move for the bot by searching the root moves within a window (principal variation search)
+     * @param depth The depth to search to
+     * @param bestMoveSoFar The best move found so far, used when iterative deepening has already found a good move
+     * @param alpha The lower bound of the root window
+     * @param beta The upper bound of the root window
+     * @param evaluation The evaluation of the root (fail-hard, so alpha on a fail-low and at least beta on a fail-high)
+     */
+    Move generateBestMove(int depth, Move bestMoveSoFar, int alpha, int beta, int& evaluation);
+
+    /**
+     * @brief Searches the root with an aspiration window around the previous iteration's evaluation, widening it on fail-high/fail-low
      * @param depth The depth to search to
      * @param bestMoveSoFar The best move found so far, used when iterative deepening has already found a good move
      */
-    Move generateBestMove(int depth, Move bestMoveSoFar = NULL_MOVE);
+    Move aspirationSearch(int depth, Move bestMoveSoFar);
 
     /**
      * @brief Uses iterative deepening to find the best move in a constant amount of time
-     * @param time The time in milliseconds to search for
+     * @param time The time in milliseconds to search for, -1 to search until cancelled or another limit is reached
      */
     Move iterativeDeepeningSearch(int time);
 
+    /**
+     * @brief Runs the iterative deepening loop until the search is cancelled, a mate is found or the depth limit is reached
+     * @param startDepth The first depth to search (helper threads start at staggered depths)
+     */
+    Move runIterativeDeepening(int startDepth);
+
     /**
      * @brief Gets the static evaluation of the current position, from the perspective of the side to move (positive if favorable, negative if unfavorable)
+     * @note Mates and draws are not detected here, the search handles them where it already knows the legal moves
      */
     int getStaticEvaluation();
 
@@ -186,8 +379,9 @@ namespace TungstenChess
 
     /**
      * @brief Gets the positional evaluation of the current position, independent of the side to move (positive for white favor, negative for black favor)
+     * @return The midgame and endgame evaluations, see makeScore
      */
-    int getPositionalEvaluation() const;
+    Score getPositionalEvaluation() const;
 
     /**
      * @brief Gets the mobility evaluation of the current position, independent of the side to move (positive for white favor, negative for black favor)
@@ -196,32 +390,74 @@ namespace TungstenChess
 
     /**
      * @brief Gets the evaluation bonus for the current position, independent of the side to move (positive for white favor, negative for black favor)
+     * @return The midgame and endgame evaluations, see makeScore
      */
-    int getEvaluationBonus() const;
+    Score getEvaluationBonus();
 
     /**
-     * @brief Negamax search with alpha-beta pruning and quiescence search
-     * @param depth The depth to search to
-     * @param alpha The alpha value for alpha-beta pruning
-     * @param beta The beta value for alpha-beta pruning
-     * @param quiesce Whether the search is in quiescence mode (captures only)
-     * @return The evaluation of the current position, from the perspective of the side to move (positive if favorable, negative if unfavorable)
+     * @brief Gets the pawn structure of the current position from the pawn hash table, evaluating it on a miss
+     */
+    const PawnHashTable::Entry& getPawnStructure();
+
+    /**
+     * @brief Converts a mate score from plies to mate from the root into plies to mate from the current node, so that a
+     *        transposition table entry stays correct wherever the position is reached again
      */
-    int negamax(int depth, int alpha = -INF_EVAL, int beta = INF_EVAL, bool quiesce = false);
+    int evaluationToTranspositionTable(int evaluation) const
+    {
+      if (evaluation >= MATE_THRESHOLD)
+        return evaluation + m_searchPly;
+      if (evaluation <= -MATE_THRESHOLD)
+        return evaluation - m_searchPly;
+      return evaluation;
+    }
 
     /**
-     * @brief Heuristic evaluation of a move, used for move ordering to improve alpha-beta pruning
-     * @param move The move to evaluate
-     * @param bestMove The best move found so far, used when iterative deepening has already found a good move
+     * @brief Converts a mate score stored in the transposition table back into plies to mate from the root
      */
-    int heuristicEvaluation(Move move, Move bestMove = NULL_MOVE);
+    int evaluationFromTranspositionTable(int evaluation) const
+    {
+      if (evaluation >= MATE_THRESHOLD)
+        return evaluation - m_searchPly;
+      if (evaluation <= -MATE_THRESHOLD)
+        return evaluation + m_searchPly;
+      return evaluation;
+    }
 
     /**
-     * @brief Sorts moves by heuristic evaluation (in place) to improve alpha-beta pruning
-     * @param moves The moves to sort
-     * @param numMovesToSort The number of moves to sort
-     * @param bestMove The best move found so far, used when iterative deepening has already found a good move
+     * @brief Records the move about to be searched at the current ply on the search stack
+     */
+    void recordSearchMove(Move move, bool capture)
+    {
+      if (m_searchPly < MoveHistory::MAX_PLY)
+      {
+        m_searchStack[m_searchPly].move = move;
+        m_searchStack[m_searchPly].capture = capture;
+      }
+    }
+
+    /**
+     * @brief Gets the move that led to the current ply, NULL_MOVE at the root or after a null move
+     */
+    Move getPreviousSearchMove() const
+    {
+      return m_searchPly > 0 && m_searchPly <= MoveHistory::MAX_PLY ? m_searchStack[m_searchPly - 1].move : NULL_MOVE;
+    }
+
+    /**
+     * @brief Checks if the search must stop, either because it reached its limits or because a stop was requested
+     */
+    bool isSearchStopped() const { return m_searchCancelled || m_stopRequested; }
+
+    /**
+     * @brief Negamax search with alpha-beta pruning and quiescence search
+     * @param depth The depth to search to
+     * @param alpha The alpha value for alpha-beta pruning
+     * @param beta The beta value for alpha-beta pruning
+     * @param quiesce Whether the search is in quiescence mode (captures only)
+     * @param allowNullMove Whether null move pruning may be tried at this node (false right after a null move and in verification searches)
+     * @return The evaluation of the current position, from the perspective of the side to move (positive if favorable, negative if unfavorable)
      */
-    void heuristicSortMoves(MoveAllocation& moves, int numMovesToSort, Move bestMove = NULL_MOVE);
+    int negamax(int depth, int alpha = -INF_EVAL, int beta = INF_EVAL, bool quiesce = false, bool allowNullMove = true);
   };
 }
\ No newline at end of file
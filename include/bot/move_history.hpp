@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+
+#include "core/move.hpp"
+#include "utils/types.hpp"
+
+namespace TungstenChess
+{
+  /**
+   * @brief Statistics about which quiet moves caused beta cutoffs, used to order quiet moves: killer moves per ply,
+   *        a butterfly history table indexed by [color][from][to] and counter moves indexed by the previous move.
+   *        Each search thread owns its own, so it is never shared or synchronized
+   */
+  class MoveHistory
+  {
+  public:
+    static constexpr int MAX_PLY = 128;
+    static constexpr int KILLER_MOVES_PER_PLY = 2;
+
+    static constexpr int MAX_HISTORY = 16384; // History scores stay within [-MAX_HISTORY, MAX_HISTORY]
+    static constexpr int MAX_HISTORY_BONUS = 2048;
+
+    MoveHistory() { clear(); }
+
+    /**
+     * @brief Forgets everything, e.g. for a new game
+     */
+    void clear();
+
+    /**
+     * @brief Prepares for a new search - killer moves are specific to the previous search's plies, so they are
+     *        cleared, while history scores are halved so that they still help but adapt to the new position
+     */
+    void newSearch();
+
+    /**
+     * @brief Records a quiet move that caused a beta cutoff, rewarding it and penalizing the quiet moves searched before it
+     * @param color The color that played the move
+     * @param ply The ply from the root of the search
+     * @param depth The remaining depth of the node, deeper cutoffs are rewarded more
+     * @param previousMove The opponent's move leading to the node, NULL_MOVE if unknown
+     * @param move The move that caused the cutoff
+     * @param failedQuiets The quiet moves searched before it without a cutoff
+     * @param failedQuietsCount The number of moves in failedQuiets
+     */
+    void updateQuietCutoff(PieceColor color, int ply, int depth, Move previousMove, Move move, const Move* failedQuiets, int failedQuietsCount);
+
+    int historyScore(PieceColor color, Move move) const
+    {
+      return m_history[color == BLACK][move & FROM][(move & TO) >> 6];
+    }
+
+    Move killerMove(int ply, int index) const
+    {
+      return ply < MAX_PLY ? m_killerMoves[ply][index] : NULL_MOVE;
+    }
+
+    Move counterMove(Move previousMove) const
+    {
+      return previousMove == NULL_MOVE ? NULL_MOVE : m_counterMoves[previousMove & FROM][(previousMove & TO) >> 6];
+    }
+
+  private:
+    std::array<std::array<Move, KILLER_MOVES_PER_PLY>, MAX_PLY> m_killerMoves;
+    std::array<std::array<std::array<int16_t, 64>, 64>, 2> m_history;
+    std::array<std::array<Move, 64>, 64> m_counterMoves;
+
+    /**
+     * @brief Applies a bonus (or a penalty if negative) to a history score with gravity, so that scores
+     *        saturate smoothly towards MAX_HISTORY instead of overflowing
+     */
+    void updateHistory(PieceColor color, Move move, int bonus);
+  };
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+
+#include "bot/move_history.hpp"
+#include "core/board.hpp"
+
+namespace TungstenChess
+{
+  /**
+   * @brief Yields the legal moves of a position in order of expected strength, generating and scoring
+   *        each stage only once the previous one has been exhausted. Since most cutoffs happen on the first
+   *        few moves, the later stages are often never generated at all
+   */
+  class MovePicker
+  {
+  public:
+    enum Stage : uint8_t
+    {
+      HASH_MOVE,
+      GENERATE_CAPTURES,
+      GOOD_CAPTURES,
+      REFUTATIONS,
+      GENERATE_QUIETS,
+      QUIETS,
+      BAD_CAPTURES,
+      ALL_MOVES,
+      DONE
+    };
+
+    /**
+     * @param board The board to pick moves for (moves are generated for the side to move)
+     * @param moveStack The auxiliary move stack to generate moves into
+     * @param hashMove The move from the transposition table, tried first if it is legal
+     * @param onlyCaptures Whether to only pick captures that do not lose material (for quiescence search)
+     * @param moveHistory The search thread's move history, to try killer and counter moves right after the good
+     *        captures and order the remaining quiet moves by history score. Quiet moves are ordered by piece-square
+     *        table gain instead if nullptr
+     * @param ply The ply from the root of the search, for killer moves
+     * @param previousMove The opponent's move leading to the position, for counter moves
+     */
+    MovePicker(Board& board, MoveStack& moveStack, Move hashMove, bool onlyCaptures = false,
+               const MoveHistory* moveHistory = nullptr, int ply = 0, Move previousMove = NULL_MOVE);
+
+    /**
+     * @brief Generates and scores every legal move at once instead of in stages, for when the number of moves is needed up front
+     * @return The number of legal moves
+     * @note Must be called before the first call to next()
+     */
+    int generateAllMoves();
+
+    /**
+     * @brief Gets the next move to search
+     * @return The next move, or NULL_MOVE once all moves have been picked
+     */
+    Move next();
+
+  private:
+    Board& m_board;
+    MoveAllocation m_moves;
+    std::array<int, MAX_LEGAL_MOVE_COUNT> m_scores;
+
+    Move m_hashMove;
+    bool m_onlyCaptures;
+
+    const MoveHistory* m_moveHistory;
+
+    // Killer moves and the counter move, in the order they are tried. Refutations that turn out not to be
+    // legal quiet moves are replaced by NULL_MOVE once reached, so the rest are skipped by quiet move generation
+    std::array<Move, MoveHistory::KILLER_MOVES_PER_PLY + 1> m_refutations;
+    size_t m_currentRefutation = 0;
+
+    Stage m_stage = HASH_MOVE;
+
+    size_t m_current = 0;
+    size_t m_end = 0;
+
+    size_t m_badCapturesBegin = 0;
+    size_t m_badCapturesEnd = 0;
+
+    static constexpr int GOOD_CAPTURE_SCORE = 1 << 20;
+    static constexpr int REFUTATION_SCORE = GOOD_CAPTURE_SCORE - MoveHistory::KILLER_MOVES_PER_PLY - 1; // Between good captures and quiet moves
+    static constexpr int QUIET_PROMOTION_MULTIPLIER = 64; // Keeps quiet promotions above any history score
+
+    /**
+     * @brief Checks if a move was already picked before its stage was generated (the hash move or a refutation)
+     */
+    bool isPicked(Move move) const;
+
+    /**
+     * @brief Generates moves of a type onto the end of the move list, scores them, and removes the moves already picked
+     * @param moveType The type of moves to generate
+     */
+    void generate(Board::MoveType moveType);
+
+    /**
+     * @brief Swaps the highest scoring move in [m_current, m_end) to m_current and returns its score
+     */
+    int selectBest();
+
+    /**
+     * @brief Scores a capture by most valuable victim / least valuable attacker, with captures that do not lose material
+     *        in the static exchange evaluation scored above GOOD_CAPTURE_SCORE
+     */
+    int scoreCapture(Move move) const;
+
+    /**
+     * @brief Scores a quiet move by its history score, or the piece-square table gain of the moving piece if there is
+     *        no move history (and promotion value either way)
+     */
+    int scoreQuiet(Move move) const;
+
+    bool isCapture(Move move) const;
+  };
+}
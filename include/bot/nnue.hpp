@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <memory>
+
+#include "core/cpu_features.hpp"
+#include "core/nnue_accumulator.hpp"
+#include "utils/types.hpp"
+
+namespace TungstenChess
+{
+  /**
+   * @brief An efficiently updatable neural network evaluation with HalfKP input features:
+   *        (own king square, non-king piece, square) -> HIDDEN_SIZE, for each perspective, followed by
+   *        a clipped ReLU and a single output neuron over both perspectives (side to move first)
+   */
+  class NNUE
+  {
+  public:
+    static constexpr int HIDDEN_SIZE = NNUEAccumulator::HIDDEN_SIZE;
+    static constexpr int INPUT_SIZE = NNUEAccumulator::INPUT_SIZE;
+
+    static constexpr int QA = 255;    // Quantization of the accumulator, also the clipped ReLU ceiling
+    static constexpr int QB = 64;     // Quantization of the output weights
+    static constexpr int SCALE = 400; // Output scale from the network's units to centipawns
+
+    typedef NNUEAccumulator Accumulator;
+
+    /**
+     * @brief Loads the network from a file, keeping the previous network (if any) if the file is missing or invalid
+     * @param path The path to the network file
+     * @return Whether a network was loaded
+     */
+    static bool loadNetwork(const std::filesystem::path& path);
+
+    static bool isLoaded() { return s_network != nullptr; }
+
+    /**
+     * @brief Replaces the network with small pseudo-random weights (the same for a given seed), so that the accumulator
+     *        updates and the kernels can be verified without a trained network
+     * @param seed The seed of the weights
+     */
+    static void generateRandomNetwork(uint64_t seed);
+
+    /**
+     * @brief Updates the accumulator for a single square change
+     * @param accumulator The accumulator to update
+     * @param kingIndices The squares of the white and black kings
+     * @param square The square that changed
+     * @param oldPiece The piece that was on the square
+     * @param newPiece The piece that is on the square now
+     */
+    static void updateAccumulator(Accumulator& accumulator, const std::array<Square, 2>& kingIndices, Square square, Piece oldPiece, Piece newPiece);
+
+    /**
+     * @brief Recomputes a perspective of the accumulator from scratch
+     * @param accumulator The accumulator to refresh
+     * @param perspective The perspective to refresh (0 for white, 1 for black)
+     * @param kingIndex The square of the perspective's king
+     * @param board The pieces on the board
+     */
+    static void refreshAccumulator(Accumulator& accumulator, int perspective, Square kingIndex, const std::array<Piece, 64>& board);
+
+    /**
+     * @brief Evaluates an up to date accumulator from the side to move's perspective, in centipawns
+     * @param accumulator The accumulator to evaluate
+     * @param sideToMove The side to move
+     */
+    static int evaluate(const Accumulator& accumulator, PieceColor sideToMove);
+
+  private:
+    struct Network
+    {
+      alignas(64) std::array<int16_t, INPUT_SIZE * HIDDEN_SIZE> featureWeights;
+      alignas(64) std::array<int16_t, HIDDEN_SIZE> featureBiases;
+      alignas(64) std::array<int16_t, 2 * HIDDEN_SIZE> outputWeights;
+      int32_t outputBias;
+    };
+
+    static inline std::unique_ptr<Network> s_network = nullptr;
+
+    static void addFeature(std::array<int16_t, HIDDEN_SIZE>& values, int featureIndex);
+    static void removeFeature(std::array<int16_t, HIDDEN_SIZE>& values, int featureIndex);
+
+    typedef void (*AccumulateFunction)(int16_t* values, const int16_t* weights);
+    typedef int32_t (*OutputFunction)(const int16_t* values, const int16_t* weights);
+
+    /**
+     * @brief The vectorized loops of the network (over HIDDEN_SIZE values), selected once at startup for the running CPU
+     */
+    struct Kernels
+    {
+      AccumulateFunction addWeights;
+      AccumulateFunction subtractWeights;
+      OutputFunction activatedDotProduct; // The sum of the clipped ReLU of the values multiplied by the weights
+    };
+
+    static Kernels s_kernels;
+    static const bool s_kernelsSelected;
+
+    /**
+     * @brief Upgrades the kernels to the fastest ones the running CPU supports
+     * @return Always true, so it can be used as a static initializer
+     */
+    static bool selectKernels();
+
+    // Kernels for the instruction set enabled by the build flags
+    static void addWeights(int16_t* values, const int16_t* weights);
+    static void subtractWeights(int16_t* values, const int16_t* weights);
+    static int32_t activatedDotProduct(const int16_t* values, const int16_t* weights);
+
+#ifdef TUNGSTENCHESS_X86
+    static void addWeightsAvx2(int16_t* values, const int16_t* weights);
+    static void subtractWeightsAvx2(int16_t* values, const int16_t* weights);
+    static int32_t activatedDotProductAvx2(const int16_t* values, const int16_t* weights);
+#endif
+  };
+}
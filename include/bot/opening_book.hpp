@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <fstream>
 #include <vector>
 
@@ -17,6 +18,7 @@ namespace TungstenChess
     std::vector<Move> m_moves;
 
     ZobristKey m_startingZobristKey;
+    ZobristKey m_bookZobristKey = 0; // The key of the position the loaded book starts from
 
     bool m_inOpeningBook = true;
     int m_lastMoveIndex = -1;
@@ -34,6 +36,12 @@ namespace TungstenChess
      */
     void loadOpeningBook(const std::filesystem::path& path);
 
+    /**
+     * @brief Clears the move history, starting again from a new position
+     * @param startingZobristKey The Zobrist key of the new starting position
+     */
+    void reset(ZobristKey startingZobristKey);
+
     /**
      * @brief Adds a move to the move history
      * @param move The move to add
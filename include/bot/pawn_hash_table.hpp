@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "core/bitboard.hpp"
+#include "core/zobrist.hpp"
+
+namespace TungstenChess
+{
+  /**
+   * @brief A cache of pawn structure evaluations indexed by the board's pawn key. Pawn structure rarely changes between
+   *        neighboring nodes, so nearly every evaluation hits. Each search thread owns its own, so it is never shared or synchronized.
+   *        Entries only depend on the pawn key, so the table never holds stale data and does not need clearing between games
+   */
+  class PawnHashTable
+  {
+  public:
+    static constexpr size_t ENTRY_COUNT = 65536; // Must be a power of 2
+
+    /**
+     * @brief The pawn structure of a position, independent of the side to move
+     */
+    struct Entry
+    {
+      ZobristKey key = 0;
+      Score score = 0;                       // Doubled, isolated and passed pawn terms (positive for white favor), see makeScore
+      std::array<uint8_t, 2> pawnFiles = {}; // Files containing pawns as bit flags (0 for white, 1 for black)
+    };
+
+    PawnHashTable()
+        : m_entries(new Entry[ENTRY_COUNT]())
+    {}
+
+    /**
+     * @brief Gets the slot of a pawn key, which holds the pawn structure if its key matches and must be recomputed otherwise
+     * @param pawnKey The pawn key of the position
+     */
+    Entry& slot(ZobristKey pawnKey) { return m_entries[pawnKey & (ENTRY_COUNT - 1)]; }
+
+    /**
+     * @brief Gets the files neighboring any of the given files, as bit flags
+     */
+    static constexpr uint8_t neighboringFiles(uint8_t files) { return uint8_t(files << 1) | (files >> 1); }
+
+  private:
+    std::unique_ptr<Entry[]> m_entries;
+  };
+}
@@ -4,6 +4,41 @@ namespace TungstenChess
 {
   constexpr std::array<int, 7> PIECE_VALUES = { 0, 100, 300, 300, 500, 900, 0 };
 
+  /**
+   * @brief Packs a midgame and an endgame score into a Score (endgame in the upper 16 bits, midgame in the lower 16 bits)
+   */
+  constexpr Score makeScore(int midgame, int endgame) { return Score(uint32_t(endgame) << 16) + midgame; }
+
+  constexpr int midgameScore(Score score) { return int16_t(uint16_t(uint32_t(score))); }
+  constexpr int endgameScore(Score score) { return int16_t(uint16_t((uint32_t(score) + 0x8000) >> 16)); }
+
+  // Game phase weights of the non-pawn pieces, the phase is MAX_PHASE with all of them on the board and 0 with none
+  constexpr std::array<int, 7> PHASE_WEIGHTS = { 0, 0, 1, 1, 2, 4, 0 };
+  constexpr int MAX_PHASE = 24;
+
+  /**
+   * @brief Interpolates between the midgame and endgame scores by game phase
+   * @param score The packed score
+   * @param phase The game phase (can exceed MAX_PHASE after promotions)
+   */
+  constexpr int taperScore(Score score, int phase)
+  {
+    phase = phase < MAX_PHASE ? phase : MAX_PHASE;
+    return (midgameScore(score) * phase + endgameScore(score) * (MAX_PHASE - phase)) / MAX_PHASE;
+  }
+
+  constexpr Score BISHOP_PAIR_BONUS = makeScore(100, 100);
+  constexpr Score CASTLED_KING_BONUS = makeScore(25, 0);
+  constexpr Score CAN_CASTLE_BONUS = makeScore(25, 0);
+  constexpr Score ROOK_ON_OPEN_FILE_BONUS = makeScore(50, 25);
+  constexpr Score ROOK_ON_SEMI_OPEN_FILE_BONUS = makeScore(25, 15);
+  constexpr Score KNIGHT_OUTPOST_BONUS = makeScore(50, 30);
+  constexpr Score PASSED_PAWN_BONUS = makeScore(30, 70);
+  constexpr Score DOUBLED_PAWN_PENALTY = makeScore(50, 50);
+  constexpr Score ISOLATED_PAWN_PENALTY = makeScore(25, 25);
+  constexpr Score BACKWARDS_PAWN_PENALTY = makeScore(50, 50);
+  constexpr Score KING_SAFETY_PAWN_SHIELD_PER_PAWN_BONUS = makeScore(20, 0);
+
   template <typename T, std::size_t N, std::size_t... I>
   constexpr std::array<T, N> reverse_impl(const std::array<T, N>& a, std::index_sequence<I...>)
   {
@@ -20,14 +55,32 @@ namespace TungstenChess
   constexpr std::array<int, 64> WHITE_KNIGHT_EVAL_TABLE = { -50, -40, -30, -30, -30, -30, -40, -50, -40, -20, 0, 0, 0, 0, -20, -40, -30, 0, 10, 15, 15, 10, 0, -30, -30, 5, 15, 20, 20, 15, 5, -30, -30, 0, 15, 20, 20, 15, 0, -30, -30, 5, 10, 15, 15, 10, 5, -30, -40, -20, 0, 5, 5, 0, -20, -40, -50, -40, -30, -30, -30, -30, -40, -50 };
   constexpr std::array<int, 64> WHITE_BISHOP_EVAL_TABLE = { -20, -10, -10, -10, -10, -10, -10, -20, -10, 0, 0, 0, 0, 0, 0, -10, -10, 0, 5, 10, 10, 5, 0, -10, -10, 5, 5, 10, 10, 5, 5, -10, -10, 0, 10, 10, 10, 10, 0, -10, -10, 10, 10, 10, 10, 10, 10, -10, -10, 5, 0, 0, 0, 0, 5, -10, -20, -10, -10, -10, -10, -10, -10, -20 };
   constexpr std::array<int, 64> WHITE_ROOK_EVAL_TABLE = { 0, 0, 0, 0, 0, 0, 0, 0, 5, 10, 10, 10, 10, 10, 10, 5, -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5, -5, 0, 0, 0, 0, 0, 0, -5, 0, 0, 0, 5, 5, 0, 0, 0 };
+  constexpr std::array<int, 64> WHITE_PAWN_ENDGAME_EVAL_TABLE = { 0, 0, 0, 0, 0, 0, 0, 0, 80, 80, 80, 80, 80, 80, 80, 80, 50, 50, 50, 50, 50, 50, 50, 50, 30, 30, 30, 30, 30, 30, 30, 30, 15, 15, 15, 15, 15, 15, 15, 15, 5, 5, 5, 5, 5, 5, 5, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
   constexpr std::array<int, 64> WHITE_QUEEN_EVAL_TABLE = { -20, -10, -10, -5, -5, -10, -10, -20, -10, 0, 0, 0, 0, 0, 0, -10, -10, 0, 5, 5, 5, 5, 0, -10, -5, 0, 5, 5, 5, 5, 0, -5, 0, 0, 5, 5, 5, 5, 0, -5, -10, 5, 5, 5, 5, 5, 0, -10, -10, 0, 5, 0, 0, 0, 0, -10, -20, -10, -10, -5, -5, -10, -10, -20 };
 
   constexpr std::array<int, 64> KING_EVAL_TABLE = { -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30, -30, -40, -40, -50, -50, -40, -40, -30, -20, -30, -30, -40, -40, -30, -30, -20, -10, -20, -20, -20, -20, -20, -20, -10, 20, 20, 0, 0, 0, 0, 20, 20, 20, 30, 10, 0, 0, 10, 30, 20 };
   constexpr std::array<int, 64> KING_ENDGAME_EVAL_TABLE = { -50, -30, -30, -30, -30, -30, -30, -50, -30, -30, 0, 0, 0, 0, -30, -30, -30, -10, 20, 30, 30, 20, -10, -30, -30, -10, 30, 40, 40, 30, -10, -30, -30, -10, 30, 40, 40, 30, -10, -30, -30, -10, 20, 30, 30, 20, -10, -30, -30, -20, -10, 0, 0, -10, -20, -30, -50, -40, -30, -20, -20, -30, -40, -50 };
   constexpr std::array<int, 16> KINGS_DISTANCE_EVAL_TABLE = { 0, 0, 70, 70, 50, 30, 20, 0, -10, -20, -30, -40, -50, -60, -70, -70 };
 
-  constexpr std::array<int, 64> PIECE_EVAL_TABLES[PIECE_NUMBER] = {
-    { { 0 } },
+  /**
+   * @brief Packs a midgame and an endgame piece-square table into a table of Scores
+   */
+  constexpr std::array<Score, 64> packEvalTables(const std::array<int, 64>& midgameTable, const std::array<int, 64>& endgameTable)
+  {
+    std::array<Score, 64> packedTable = {};
+    for (std::size_t i = 0; i < 64; i++)
+      packedTable[i] = makeScore(midgameTable[i], endgameTable[i]);
+    return packedTable;
+  }
+
+  constexpr std::array<Score, 64> WHITE_PAWN_SCORES = packEvalTables(WHITE_PAWN_EVAL_TABLE, WHITE_PAWN_ENDGAME_EVAL_TABLE);
+  constexpr std::array<Score, 64> WHITE_KNIGHT_SCORES = packEvalTables(WHITE_KNIGHT_EVAL_TABLE, WHITE_KNIGHT_EVAL_TABLE);
+  constexpr std::array<Score, 64> WHITE_BISHOP_SCORES = packEvalTables(WHITE_BISHOP_EVAL_TABLE, WHITE_BISHOP_EVAL_TABLE);
+  constexpr std::array<Score, 64> WHITE_ROOK_SCORES = packEvalTables(WHITE_ROOK_EVAL_TABLE, WHITE_ROOK_EVAL_TABLE);
+  constexpr std::array<Score, 64> WHITE_QUEEN_SCORES = packEvalTables(WHITE_QUEEN_EVAL_TABLE, WHITE_QUEEN_EVAL_TABLE);
+  constexpr std::array<Score, 64> WHITE_KING_SCORES = packEvalTables(KING_EVAL_TABLE, KING_ENDGAME_EVAL_TABLE);
+
+  constexpr std::array<Score, 64> PIECE_EVAL_TABLES[PIECE_NUMBER] = {
     { { 0 } },
     { { 0 } },
     { { 0 } },
@@ -36,19 +89,20 @@ namespace TungstenChess
     { { 0 } },
     { { 0 } },
     { { 0 } },
-    WHITE_PAWN_EVAL_TABLE,
-    WHITE_KNIGHT_EVAL_TABLE,
-    WHITE_BISHOP_EVAL_TABLE,
-    WHITE_ROOK_EVAL_TABLE,
-    WHITE_QUEEN_EVAL_TABLE,
     { { 0 } },
+    WHITE_PAWN_SCORES,
+    WHITE_KNIGHT_SCORES,
+    WHITE_BISHOP_SCORES,
+    WHITE_ROOK_SCORES,
+    WHITE_QUEEN_SCORES,
+    WHITE_KING_SCORES,
     { { 0 } },
     { { 0 } },
-    reverse(WHITE_PAWN_EVAL_TABLE),
-    reverse(WHITE_KNIGHT_EVAL_TABLE),
-    reverse(WHITE_BISHOP_EVAL_TABLE),
-    reverse(WHITE_ROOK_EVAL_TABLE),
-    reverse(WHITE_QUEEN_EVAL_TABLE),
-    { { 0 } }
+    reverse(WHITE_PAWN_SCORES),
+    reverse(WHITE_KNIGHT_SCORES),
+    reverse(WHITE_BISHOP_SCORES),
+    reverse(WHITE_ROOK_SCORES),
+    reverse(WHITE_QUEEN_SCORES),
+    reverse(WHITE_KING_SCORES)
   };
-}
\ No newline at end of file
+}
@@ -1,59 +1,146 @@
 #pragma once
 
-#include <vector>
+#include <atomic>
+#include <memory>
+#include <string>
 
+#include "core/move.hpp"
 #include "core/zobrist.hpp"
 
 #define MEGABYTE 1048576
 
+#define CACHE_LINE_SIZE 64
+
 namespace TungstenChess
 {
   class TranspositionTable
   {
   public:
+    enum Bound : uint8_t
+    {
+      NO_BOUND = 0,
+      UPPER_BOUND = 1, // Evaluation is at most the stored value (fail-low)
+      LOWER_BOUND = 2, // Evaluation is at least the stored value (fail-high)
+      EXACT_BOUND = 3
+    };
+
+    /**
+     * @brief A decoded transposition table entry. Entries are packed into 64 bits so that they can be
+     *        stored and verified lock-free alongside the Zobrist key
+     */
     class Entry
     {
     private:
-      ZobristKey m_key;
-      uint m_searchId : 12;
-      int m_evaluation : 21;
-      uint m_depth : 6;
-      bool m_quiesce : 1;
+      uint64_t m_data = 0;
+
+      static constexpr int EVALUATION_SHIFT = 0;
+      static constexpr int MOVE_SHIFT = 32;
+      static constexpr int DEPTH_SHIFT = 48;
+      static constexpr int GENERATION_SHIFT = 56;
+      static constexpr int BOUND_SHIFT = 61;
+      static constexpr int QUIESCE_SHIFT = 63;
 
     public:
+      static constexpr uint8_t GENERATION_MASK = 0x1F;
+
       Entry() = default;
 
-      Entry(ZobristKey key, uint searchId, int evaluation, int depth, bool quiesce);
+      explicit Entry(uint64_t data)
+          : m_data(data)
+      {}
 
-      void overwrite(ZobristKey key, uint searchId, int evaluation, int depth, bool quiesce);
+      Entry(Move move, int evaluation, int depth, Bound bound, bool quiesce, uint8_t generation);
 
-      bool isOccupied() const { return m_key; }
-      ZobristKey key() const { return m_key; }
-      uint searchId() const { return m_searchId; }
-      int evaluation() const { return m_evaluation; }
-      int depth() const { return m_depth; }
-      bool quiesce() const { return m_quiesce; }
+      uint64_t data() const { return m_data; }
 
-      bool isSameKey(ZobristKey key) const { return m_key == key; }
+      bool isOccupied() const { return bound() != NO_BOUND; }
+      int evaluation() const { return int32_t(m_data >> EVALUATION_SHIFT); }
+      Move move() const { return Move(m_data >> MOVE_SHIFT); }
+      int depth() const { return int8_t(m_data >> DEPTH_SHIFT); }
+      uint8_t generation() const { return (m_data >> GENERATION_SHIFT) & GENERATION_MASK; }
+      Bound bound() const { return Bound((m_data >> BOUND_SHIFT) & 3); }
+      bool quiesce() const { return m_data >> QUIESCE_SHIFT; }
     };
 
   private:
-    const int TABLE_SIZE;
-    std::vector<Entry> m_transpositionTable;
-    int m_occupied = 0;
+    /**
+     * @brief A single slot of a bucket. The key is stored XORed with the data, so a torn write from another
+     *        thread fails verification on probe instead of returning mismatched data
+     */
+    struct Slot
+    {
+      std::atomic<uint64_t> keyXorData;
+      std::atomic<uint64_t> data;
+    };
+
+    static constexpr int BUCKET_SIZE = CACHE_LINE_SIZE / sizeof(Slot);
+
+    struct alignas(CACHE_LINE_SIZE) Bucket
+    {
+      Slot slots[BUCKET_SIZE];
+    };
+
+    static_assert(sizeof(Bucket) == CACHE_LINE_SIZE, "Transposition table buckets must fill exactly one cache line");
+
+    const size_t BUCKET_COUNT;
+    std::unique_ptr<Bucket[]> m_buckets;
+
+    uint8_t m_generation = 0;
 
   public:
-    TranspositionTable(int sizeMB)
-        : TABLE_SIZE(sizeMB * MEGABYTE / sizeof(Entry)),
-          m_transpositionTable(TABLE_SIZE)
+    TranspositionTable(size_t sizeMB)
+        : BUCKET_COUNT(sizeMB * MEGABYTE / sizeof(Bucket)),
+          m_buckets(new Bucket[BUCKET_COUNT]())
     {}
 
+    /**
+     * @brief Removes all entries from the table
+     * @note Must not be called while the table is being searched
+     */
+    void clear();
+
+    /**
+     * @brief Advances the generation, marking all existing entries as belonging to an older search
+     */
+    void newSearch() { m_generation = (m_generation + 1) & Entry::GENERATION_MASK; }
+
+    uint8_t generation() const { return m_generation; }
+
+    /**
+     * @brief Estimates how full the table is with entries from the current search, in permille (as reported by UCI hashfull)
+     */
+    int hashfull() const;
+
     std::string occupancy() const;
 
-    bool hasEntry(ZobristKey key) const;
+    /**
+     * @brief Looks up a position in the table
+     * @param key The Zobrist key of the position
+     * @param entry The entry to store the result in (only valid if found)
+     * @return Whether an entry for the position was found
+     */
+    bool probe(ZobristKey key, Entry& entry) const;
 
-    const Entry& retrieve(ZobristKey key, bool& found);
+    /**
+     * @brief Stores a search result, replacing the least valuable entry of the bucket (shallowest and oldest)
+     * @param key The Zobrist key of the position
+     * @param move The best move found (NULL_MOVE keeps the move already stored for the position, if any)
+     * @param evaluation The evaluation of the position
+     * @param depth The depth searched
+     * @param bound The type of bound the evaluation represents
+     * @param quiesce Whether the result comes from quiescence search
+     */
+    void store(ZobristKey key, Move move, int evaluation, int depth, Bound bound, bool quiesce);
+
+  private:
+    /**
+     * @brief Maps a key onto a bucket with a multiply-shift, which works for any table size
+     */
+    Bucket& bucket(ZobristKey key) const { return m_buckets[(unsigned __int128)key * BUCKET_COUNT >> 64]; }
 
-    void store(ZobristKey key, uint searchId, int evaluation, int depth, bool quiesce);
+    /**
+     * @brief Writes an entry into a slot, storing the key XORed with the data for lock-free verification
+     */
+    static void write(Slot& slot, ZobristKey key, Entry entry);
   };
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 
 #include "core/bitboard.hpp"
 #include "core/move.hpp"
+#include "core/nnue_accumulator.hpp"
 #include "core/zobrist.hpp"
 
 #define NO_EP 8
@@ -38,6 +39,16 @@ namespace TungstenChess
     std::array<Piece, PIECE_NUMBER> m_kingIndices; // Only indices WHITE_KING and BLACK_KING are valid, the rest are garbage
     std::array<uint, PIECE_NUMBER> m_pieceCounts;
 
+    std::array<int, BLACK + 1> m_materials; // Only indices WHITE and BLACK are valid, sum of PIECE_VALUES of the color's pieces
+    Score m_positionalScore;                // Sum of PIECE_EVAL_TABLES of all pieces, from white's perspective
+    int m_phase;                            // Sum of PHASE_WEIGHTS of all pieces, see taperScore
+
+    // One accumulator per move made on this board, the last being the current position's, so that unmaking a move
+    // returns to the parent's accumulator as it was instead of reverting it (a king move leaves it stale otherwise).
+    // The values are only maintained while a network is loaded
+    std::vector<NNUEAccumulator> m_accumulators;
+    size_t m_accumulatorPly = 0;
+
     PieceColor m_sideToMove;
 
     uint8_t m_castlingRights;
@@ -46,6 +57,7 @@ namespace TungstenChess
     uint8_t m_halfmoveClock;
 
     ZobristKey m_zobristKey;
+    ZobristKey m_pawnKey; // Zobrist key of the pawns only, for caching pawn structure evaluations
 
     struct DisjointZobristKeyStack
     {
@@ -57,13 +69,18 @@ namespace TungstenChess
 
       ZobristKeyStack stack;
       const DisjointZobristKeyStack* prev;
-      const size_t prevSize;
+      size_t prevSize;
     };
 
     DisjointZobristKeyStack m_positionHistory;
 
     Board(const Board& other, size_t futureMoves);
 
+    /**
+     * @brief Copies the position of another board, everything but the position history
+     */
+    void copyPosition(const Board& other);
+
   public:
     Board(std::string fen = START_FEN);
 
@@ -75,8 +92,12 @@ namespace TungstenChess
     uint8_t halfmoveClock() const { return m_halfmoveClock; }
     const Bitboard& bitboard(Piece piece) const { return m_bitboards[piece]; }
     ZobristKey zobristKey() const { return m_zobristKey; }
+    ZobristKey pawnKey() const { return m_pawnKey; }
     Square kingIndex(Piece piece) const { return m_kingIndices[piece]; }
     uint pieceCount(Piece piece) const { return m_pieceCounts[piece]; }
+    int material(PieceColor color) const { return m_materials[color]; }
+    Score positionalScore() const { return m_positionalScore; }
+    int phase() const { return m_phase; }
 
     /**
      * @brief Resets the board to the provided fen
@@ -84,12 +105,37 @@ namespace TungstenChess
      */
     void resetBoard(std::string fen = START_FEN);
 
+    /**
+     * @brief Marks the NNUE accumulators as stale, so that they are rebuilt on the next evaluation
+     * @note Must be called after a network is loaded, as the accumulators are not maintained without one
+     */
+    void resetAccumulator();
+
+    /**
+     * @brief Gets the NNUE accumulator of the current position
+     */
+    const NNUEAccumulator& accumulator() const { return m_accumulators[m_accumulatorPly]; }
+
+    /**
+     * @brief Gets the NNUE evaluation of the current position from the side to move's perspective,
+     *        refreshing any stale perspective of the accumulator first
+     * @note A network must be loaded (see NNUE::loadNetwork)
+     */
+    int getNNUEEvaluation();
+
     /**
      * @brief Checks if a color is in check in the current position
      * @param color The color to check
      */
     bool isInCheck(PieceColor color) const;
 
+    enum MoveType : uint8_t
+    {
+      ALL_MOVES = 0,
+      CAPTURE_MOVES = 1, // Moves onto an enemy piece, including en passant
+      QUIET_MOVES = 2    // All other moves, including castling and non-capturing promotions
+    };
+
     /**
      * @brief Returns the bitboard of the squares a piece can move to
      * @param pieceIndex The index of the piece
@@ -97,12 +143,18 @@ namespace TungstenChess
     Bitboard getLegalPieceMovesBitboard(Square pieceIndex);
 
     /**
-     * @brief Gets the legal moves for a color
+     * @brief Gets the legal moves for the side to move
      * @param legalMoves The array to store the moves in
-     * @param onlyCaptures Whether to only include capture moves
+     * @param moveType Which moves to generate, see enum MoveType
      * @return The number of legal moves
      */
-    int getLegalMoves(MoveAllocation& legalMoves, bool onlyCaptures = false);
+    int getLegalMoves(MoveAllocation& legalMoves, MoveType moveType = ALL_MOVES);
+
+    /**
+     * @brief Checks if a move is legal for the side to move (used to validate moves from outside of move generation, e.g. hash moves)
+     * @param move The move to check
+     */
+    bool isLegalMove(Move move);
 
     /**
      * @brief Returns the bitboard of the squares a piece can move to, not excluding moves that leave the king in check
@@ -138,6 +190,38 @@ namespace TungstenChess
      */
     void unmakeMove(Move move, UnmoveData unmoveData);
 
+    /**
+     * @brief Passes the turn to the other side without moving a piece (null move), clearing the en passant file
+     * @note Only meant for search. The halfmove clock is reset, so that no repetition is detected across the null move
+     */
+    UnmoveData makeNullMove();
+
+    /**
+     * @brief Undoes a null move
+     * @param unmoveData The data returned by makeNullMove
+     */
+    void unmakeNullMove(UnmoveData unmoveData);
+
+    /**
+     * @brief Checks if a color has enough non-pawn material that a null move is unlikely to be wrong because of zugzwang
+     * @param color The color to check
+     */
+    bool hasNullMoveMaterial(PieceColor color) const
+    {
+      return m_pieceCounts[color | ROOK] + m_pieceCounts[color | QUEEN] > 0 ||
+             m_pieceCounts[color | KNIGHT] + m_pieceCounts[color | BISHOP] >= 2;
+    }
+
+    /**
+     * @brief Static exchange evaluation - checks if a move wins at least a given amount of material once every
+     *        recapture on its target square has been played out, each side capturing with its least valuable piece
+     *        (including x-ray attackers revealed behind it) and stopping whenever continuing would lose material
+     * @param move The move to evaluate
+     * @param threshold The material balance (in PIECE_VALUES units) the exchange must reach
+     * @note Pins are ignored, and promotions and en passant captures are only compared as an even exchange
+     */
+    bool staticExchangeEvaluation(Move move, int threshold = 0) const;
+
     enum GameStatus : uint8_t
     {
       NO_MATE = 0,
@@ -151,6 +235,12 @@ namespace TungstenChess
      */
     GameStatus getGameStatus(PieceColor color);
 
+    /**
+     * @brief Checks if a color has any legal move, stopping at the first one found (trying king moves first)
+     * @param color The color to check
+     */
+    bool hasAnyLegalMove(PieceColor color);
+
     /**
      * @brief Generates a move from a UCI string
      * @param uci The UCI string
@@ -171,10 +261,18 @@ namespace TungstenChess
     uint64_t countGames(uint8_t depth, bool verbose = true);
 
     /**
-     * @brief Checks if a position has been repeated thrice
-     * @param key The Zobrist key of the position to check
+     * @brief Checks if the current position is a draw by repetition. A single earlier occurrence within the search is
+     *        enough, as the side to move could repeat it again, while positions from before the search must occur thrice
+     * @param searchPly The number of plies from the root of the search, 0 to apply the threefold repetition rule only
+     */
+    bool isRepetition(int searchPly = 0) const;
+
+    /**
+     * @brief Checks if the side to move has a move back to a position that occurred earlier in the search, which it
+     *        could claim as a draw before the move is searched. Looks the move up in the cuckoo tables by key difference
+     * @param searchPly The number of plies from the root of the search
      */
-    bool hasRepeatedThrice(ZobristKey key) const;
+    bool hasUpcomingRepetition(int searchPly) const;
 
     /**
      * @brief Creates a copy of the board for branching search
@@ -183,6 +281,12 @@ namespace TungstenChess
      */
     Board createBranch(size_t futureMoves = MAX_GAME_LENGTH) const;
 
+    /**
+     * @brief Turns the board into a branch of another board, as createBranch does, but reusing this board's move stack
+     * @param other The board to branch from, which must outlive this board's use as its branch
+     */
+    void rebranch(const Board& other);
+
   private:
     /**
      * @brief Calculates the Zobrist key for the current position. Should only be called once at board initialization
@@ -190,6 +294,23 @@ namespace TungstenChess
      */
     ZobristKey calculateInitialZobristKey() const;
 
+    /**
+     * @brief Calculates the pawn key for the current position. Should only be called once at board initialization
+     */
+    ZobristKey calculateInitialPawnKey() const;
+
+    /**
+     * @brief Gets the Zobrist key of a position from the history, including the histories of the boards branched from
+     * @param distance The number of plies before the current position (which is at distance 0)
+     */
+    ZobristKey historyKey(int distance) const;
+
+    /**
+     * @brief Gets how many plies back a position can be repeated: no further than the last irreversible move
+     *        (or null move) and the start of the recorded history
+     */
+    int maxRepetitionDistance() const;
+
     /**
      * @brief Updates bitboards for a single changing piece
      * @param pieceIndex The index of the piece
@@ -219,8 +340,19 @@ namespace TungstenChess
      * @brief Updates the piece at a given index and handles bitboard and Zobrist key updates
      * @param pieceIndex The index of the piece to update
      * @param newPiece The new piece
+     * @param updateAccumulator Whether to update the NNUE accumulator, which unmaking a move restores instead
+     */
+    void updatePiece(Square pieceIndex, Piece newPiece, bool updateAccumulator = true);
+
+    /**
+     * @brief Starts the accumulator of a move being made from the current one
+     */
+    void pushAccumulator();
+
+    /**
+     * @brief Returns to the accumulator from before the move being unmade
      */
-    void updatePiece(Square pieceIndex, Piece newPiece);
+    void popAccumulator();
 
     /**
      * @brief Moves a piece from one square to another and handles bitboard and Zobrist key updates
@@ -288,8 +420,32 @@ namespace TungstenChess
      * @brief Returns the bitboard of the squares a piece can move to
      * @param pieceIndex The index of the piece
      * @param color The color of the piece
+     * @param moveType Which moves to include, see enum MoveType
      */
-    Bitboard getLegalPieceMovesBitboard(Square pieceIndex, PieceColor color, bool onlyCaptures = false);
+    Bitboard getLegalPieceMovesBitboard(Square pieceIndex, PieceColor color, MoveType moveType = ALL_MOVES);
+
+    /**
+     * @brief Returns the bitboard of the squares a piece can move to, using precomputed checkers and pins
+     * @param pieceIndex The index of the piece
+     * @param color The color of the piece
+     * @param moveType Which moves to include, see enum MoveType
+     * @param checkers The bitboard of enemy pieces giving check (see getCheckersBitboard)
+     * @param pinned The bitboard of friendly pieces pinned to the king (see getPinnedPiecesBitboard)
+     * @note Only king moves and en passant captures need to be validated individually
+     */
+    Bitboard getLegalPieceMovesBitboard(Square pieceIndex, PieceColor color, MoveType moveType, Bitboard checkers, Bitboard pinned);
+
+    /**
+     * @brief Returns the bitboard of enemy pieces giving check to a color's king
+     * @param color The color of the king
+     */
+    Bitboard getCheckersBitboard(PieceColor color) const;
+
+    /**
+     * @brief Returns the bitboard of a color's pieces that are pinned to its king by an enemy slider
+     * @param color The color of the king
+     */
+    Bitboard getPinnedPiecesBitboard(PieceColor color) const;
 
     /**
      * @brief Returns the bitboard of pieces that can move to a given square. Does not include kings for technical reasons
@@ -299,14 +455,21 @@ namespace TungstenChess
      */
     Bitboard getAttackingPiecesBitboard(Square targetSquare, Piece targetPiece, PieceColor color) const;
 
+    /**
+     * @brief Returns the bitboard of pieces of both colors (including kings) attacking a square, with sliders blocked by the given occupancy
+     * @param square The square to check
+     * @param occupied The occupancy bitboard used for slider attacks
+     */
+    Bitboard getAttackersBitboard(Square square, Bitboard occupied) const;
+
     /**
      * @brief Gets the legal moves for a color
      * @param legalMoves The array to store the moves in (entry after last generated move will be NULL_MOVE)
      * @param color The color to get the moves for
-     * @param onlyCaptures Whether to only include capture moves
+     * @param moveType Which moves to generate, see enum MoveType
      * @return The number of legal moves
      */
-    int getLegalMoves(MoveAllocation& legalMoves, PieceColor color, bool onlyCaptures = false);
+    int getLegalMoves(MoveAllocation& legalMoves, PieceColor color, MoveType moveType = ALL_MOVES);
 
     /**
      * @brief Checks if a square is attacked by a color
@@ -315,6 +478,14 @@ namespace TungstenChess
      */
     bool isAttacked(Square square, PieceColor color) const;
 
+    /**
+     * @brief Checks if a square is attacked by a color, with sliders blocked by the given occupancy instead of the board's
+     * @param square The square to check
+     * @param color The color to check
+     * @param occupied The occupancy bitboard used for slider attacks
+     */
+    bool isAttacked(Square square, PieceColor color, Bitboard occupied) const;
+
     /**
      * @brief Counts the number of games that can be played from the current position to a given depth
      * @param moveStack The auxiliary move stack to use for storing generated moves
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TUNGSTENCHESS_X86
+
+// Compiles a function for the given extensions regardless of the build flags, it must only run once CpuFeatures confirms them
+#define TUNGSTENCHESS_TARGET(extensions) __attribute__((target(extensions)))
+#endif
+
+namespace TungstenChess
+{
+  /**
+   * @brief The instruction set extensions of the running CPU, detected on first use. Kernels with a variant for an extension
+   *        the build does not enable select it at startup from these, so that a portable build runs well on every host
+   */
+  class CpuFeatures
+  {
+  public:
+    static bool hasPopcnt() { return features().popcnt; }
+    static bool hasBmi2() { return features().bmi2; }
+    static bool hasAvx2() { return features().avx2; }
+
+    /**
+     * @brief Checks if PEXT is faster than a magic multiplication, which it is not on AMD CPUs before Zen 3 (where it is microcoded)
+     */
+    static bool hasFastPext() { return features().bmi2 && !features().slowPext; }
+
+    /**
+     * @brief Gets the detected extensions used by the engine, for logging
+     */
+    static std::string describe();
+
+  private:
+    struct Features
+    {
+      bool popcnt = false;
+      bool bmi2 = false;
+      bool avx2 = false;
+      bool slowPext = false;
+    };
+
+    static const Features& features();
+
+    static Features detect();
+  };
+}
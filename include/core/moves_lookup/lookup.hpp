@@ -7,51 +7,243 @@
 
 namespace TungstenChess
 {
+  /**
+   * @brief Move lookup tables, generated at compile time so that nothing is computed at startup
+   */
   class MovesLookup
   {
-  public:
-    /**
-     * @brief Initializes the move lookup tables
-     */
-    static void init();
-
   private:
-    static inline std::array<Bitboard, 64> KNIGHT_MOVES = {};
-    static inline std::array<Bitboard, 64> KING_MOVES = {};
-    static inline std::array<Bitboard, 64> BISHOP_MASKS = {};
-    static inline std::array<Bitboard, 64> ROOK_MASKS = {};
+    typedef std::array<Bitboard, 64> SquareTable;
+    typedef std::array<SquareTable, BLACK_PAWN + 1> PawnTable; // Indexed by pawn, or by color (same as the color's pawn)
+    typedef std::array<SquareTable, 64> SquarePairTable;
+
+    static constexpr int DIRECTION_COUNT = 8;
+
+    // Opposite directions are stored symmetrically (i and 7 - i), with the directions towards lower squares first
+    static constexpr int RANK_DIRECTIONS[DIRECTION_COUNT] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    static constexpr int FILE_DIRECTIONS[DIRECTION_COUNT] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+    static constexpr int ROOK_DIRECTIONS[4] = { 1, 3, 4, 6 };
+    static constexpr int BISHOP_DIRECTIONS[4] = { 0, 2, 5, 7 };
+
+    static const std::array<SquareTable, DIRECTION_COUNT> RAYS; // Squares from a square to the edge of the board in a direction
+
+    static const SquareTable KNIGHT_MOVES;
+    static const SquareTable KING_MOVES;
+    static const SquareTable BISHOP_MASKS; // Squares whose occupancy can block a bishop (rays without the edge squares)
+    static const SquareTable ROOK_MASKS;   // Squares whose occupancy can block a rook (rays without the edge squares)
 
-    static inline utils::array2d<Bitboard, BLACK_PAWN + 1, 64> PAWN_CAPTURE_MOVES = {};
-    static inline utils::array2d<Bitboard, BLACK_PAWN + 1, 64> PAWN_REVERSE_SINGLE_MOVES = {};
-    static inline utils::array2d<Bitboard, BLACK_PAWN + 1, 64> PAWN_REVERSE_DOUBLE_MOVES = {};
+    static const PawnTable PAWN_CAPTURE_MOVES;
+    static const PawnTable PAWN_REVERSE_SINGLE_MOVES;
+    static const PawnTable PAWN_REVERSE_DOUBLE_MOVES;
+
+    static const SquarePairTable BETWEEN_MASKS; // Squares strictly between two aligned squares (empty if not aligned)
+    static const SquarePairTable LINE_MASKS;    // The full line (edge to edge) through two aligned squares (empty if not aligned)
 
     friend class Board;
     friend class Bot;
     friend class MagicMoveGen;
 
     /**
-     * @brief Initializes the knight move lookup table
+     * @brief Checks if a direction leads towards higher squares, where the nearest square of a ray is its lowest bit
      */
-    static void initKnightMoves();
+    static constexpr bool isPositiveDirection(int direction) { return direction >= DIRECTION_COUNT / 2; }
 
     /**
-     * @brief Initializes the king move lookup table
+     * @brief Generates a table of the squares reached by single steps from each square
+     * @param rankSteps The rank offsets of the steps
+     * @param fileSteps The file offsets of the steps
      */
-    static void initKingMoves();
+    static constexpr SquareTable generateStepMoves(const int (&rankSteps)[8], const int (&fileSteps)[8]);
 
-    /**
-     * @brief Initializes the pawn move lookup tables
-     */
-    static void initPawnMoves();
+    static constexpr std::array<SquareTable, DIRECTION_COUNT> generateRays();
 
     /**
-     * @brief Initializes the bishop mask lookup tables
+     * @brief Generates the blocker masks of a slider moving in the given directions
      */
-    static void initBishopMasks();
+    static constexpr SquareTable generateSliderMasks(const int (&directions)[4]);
 
-    /**
-     * @brief Initializes the rook mask lookup table
-     */
-    static void initRookMasks();
+    static constexpr PawnTable generatePawnCaptureMoves();
+    static constexpr PawnTable generatePawnReverseSingleMoves();
+    static constexpr PawnTable generatePawnReverseDoubleMoves();
+
+    static constexpr SquarePairTable generateBetweenMasks();
+    static constexpr SquarePairTable generateLineMasks();
   };
-}
\ No newline at end of file
+
+  constexpr MovesLookup::SquareTable MovesLookup::generateStepMoves(const int (&rankSteps)[8], const int (&fileSteps)[8])
+  {
+    SquareTable moves = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      for (int i = 0; i < 8; i++)
+      {
+        int rank = square / 8 + rankSteps[i];
+        int file = square % 8 + fileSteps[i];
+
+        if (rank >= 0 && rank <= 7 && file >= 0 && file <= 7)
+          moves[square] |= Bitboards::bit(rank * 8 + file);
+      }
+    }
+
+    return moves;
+  }
+
+  constexpr std::array<MovesLookup::SquareTable, MovesLookup::DIRECTION_COUNT> MovesLookup::generateRays()
+  {
+    std::array<SquareTable, DIRECTION_COUNT> rays = {};
+
+    for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+    {
+      for (int square = 0; square < 64; square++)
+      {
+        int rank = square / 8 + RANK_DIRECTIONS[direction];
+        int file = square % 8 + FILE_DIRECTIONS[direction];
+
+        while (rank >= 0 && rank <= 7 && file >= 0 && file <= 7)
+        {
+          rays[direction][square] |= Bitboards::bit(rank * 8 + file);
+
+          rank += RANK_DIRECTIONS[direction];
+          file += FILE_DIRECTIONS[direction];
+        }
+      }
+    }
+
+    return rays;
+  }
+
+  constexpr MovesLookup::SquareTable MovesLookup::generateSliderMasks(const int (&directions)[4])
+  {
+    SquareTable masks = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      for (int direction : directions)
+      {
+        Bitboard ray = RAYS[direction][square];
+
+        // The edge square ends the ray whether it is occupied or not
+        if (ray)
+          ray &= ~Bitboards::bit(isPositiveDirection(direction) ? 63 - __builtin_clzll(ray) : __builtin_ctzll(ray));
+
+        masks[square] |= ray;
+      }
+    }
+
+    return masks;
+  }
+
+  constexpr MovesLookup::PawnTable MovesLookup::generatePawnCaptureMoves()
+  {
+    PawnTable moves = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      Bitboard position = Bitboards::bit(square);
+
+      if (square > 7 && square % 8 > 0)
+        moves[WHITE_PAWN][square] |= position >> 9;
+      if (square > 7 && square % 8 < 7)
+        moves[WHITE_PAWN][square] |= position >> 7;
+      if (square < 56 && square % 8 > 0)
+        moves[BLACK_PAWN][square] |= position << 7;
+      if (square < 56 && square % 8 < 7)
+        moves[BLACK_PAWN][square] |= position << 9;
+    }
+
+    moves[WHITE] = moves[WHITE_PAWN];
+    moves[BLACK] = moves[BLACK_PAWN];
+
+    return moves;
+  }
+
+  constexpr MovesLookup::PawnTable MovesLookup::generatePawnReverseSingleMoves()
+  {
+    PawnTable moves = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      moves[WHITE_PAWN][square] = square < 56 ? Bitboards::bit(square + 8) : 0;
+      moves[BLACK_PAWN][square] = square > 7 ? Bitboards::bit(square - 8) : 0;
+    }
+
+    moves[WHITE] = moves[WHITE_PAWN];
+    moves[BLACK] = moves[BLACK_PAWN];
+
+    return moves;
+  }
+
+  constexpr MovesLookup::PawnTable MovesLookup::generatePawnReverseDoubleMoves()
+  {
+    PawnTable moves = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      if (square / 8 == 4)
+        moves[WHITE_PAWN][square] = Bitboards::bit(square + 16);
+      else if (square / 8 == 3)
+        moves[BLACK_PAWN][square] = Bitboards::bit(square - 16);
+    }
+
+    moves[WHITE] = moves[WHITE_PAWN];
+    moves[BLACK] = moves[BLACK_PAWN];
+
+    return moves;
+  }
+
+  constexpr MovesLookup::SquarePairTable MovesLookup::generateBetweenMasks()
+  {
+    SquarePairTable masks = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+      {
+        Bitboard ray = RAYS[direction][square];
+
+        // The squares between two squares are the ray up to the second one, without what lies beyond it
+        for (; ray; ray &= ray - 1)
+        {
+          Square to = __builtin_ctzll(ray);
+          masks[square][to] = RAYS[direction][square] & ~RAYS[direction][to] & ~Bitboards::bit(to);
+        }
+      }
+    }
+
+    return masks;
+  }
+
+  constexpr MovesLookup::SquarePairTable MovesLookup::generateLineMasks()
+  {
+    SquarePairTable masks = {};
+
+    for (int square = 0; square < 64; square++)
+    {
+      for (int direction = 0; direction < DIRECTION_COUNT; direction++)
+      {
+        Bitboard line = RAYS[direction][square] | RAYS[DIRECTION_COUNT - 1 - direction][square] | Bitboards::bit(square);
+
+        for (Bitboard ray = RAYS[direction][square]; ray; ray &= ray - 1)
+          masks[square][__builtin_ctzll(ray)] = line;
+      }
+    }
+
+    return masks;
+  }
+
+  inline constexpr std::array<MovesLookup::SquareTable, MovesLookup::DIRECTION_COUNT> MovesLookup::RAYS = generateRays();
+
+  inline constexpr MovesLookup::SquareTable MovesLookup::KNIGHT_MOVES = generateStepMoves({ -2, -2, -1, -1, 1, 1, 2, 2 }, { -1, 1, -2, 2, -2, 2, -1, 1 });
+  inline constexpr MovesLookup::SquareTable MovesLookup::KING_MOVES = generateStepMoves(RANK_DIRECTIONS, FILE_DIRECTIONS);
+  inline constexpr MovesLookup::SquareTable MovesLookup::BISHOP_MASKS = generateSliderMasks(BISHOP_DIRECTIONS);
+  inline constexpr MovesLookup::SquareTable MovesLookup::ROOK_MASKS = generateSliderMasks(ROOK_DIRECTIONS);
+
+  inline constexpr MovesLookup::PawnTable MovesLookup::PAWN_CAPTURE_MOVES = generatePawnCaptureMoves();
+  inline constexpr MovesLookup::PawnTable MovesLookup::PAWN_REVERSE_SINGLE_MOVES = generatePawnReverseSingleMoves();
+  inline constexpr MovesLookup::PawnTable MovesLookup::PAWN_REVERSE_DOUBLE_MOVES = generatePawnReverseDoubleMoves();
+
+  inline constexpr MovesLookup::SquarePairTable MovesLookup::BETWEEN_MASKS = generateBetweenMasks();
+  inline constexpr MovesLookup::SquarePairTable MovesLookup::LINE_MASKS = generateLineMasks();
+}
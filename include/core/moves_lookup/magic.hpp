@@ -1,9 +1,10 @@
 #pragma once
 
 #include <array>
-#include <vector>
 
 #include "core/bitboard.hpp"
+#include "core/cpu_features.hpp"
+#include "core/moves_lookup/lookup.hpp"
 #include "utils/types.hpp"
 #include "utils/utils.hpp"
 
@@ -21,68 +22,94 @@ namespace TungstenChess
     static constexpr Magic BISHOP_MAGICS[64] = { 15342714675989640190ULL, 6007577461340950354ULL, 16908823917554112256ULL, 6464933238120839123ULL, 13926855253894263872ULL, 7515183294807424303ULL, 3233825377581302821ULL, 16050787983471935383ULL, 17090357297884846079ULL, 11342765302400929788ULL, 4109376412544377872ULL, 17081916031869536565ULL, 17798098201767970974ULL, 10719835993853963214ULL, 11974279035893710756ULL, 9487302550151921657ULL, 14036655820037376640ULL, 18018917383005545748ULL, 4902182831682394452ULL, 15071297304116933011ULL, 1281416051290030731ULL, 7282883659898543398ULL, 5616627072528383886ULL, 15717812301732065289ULL, 14986874731646972066ULL, 3366729443656503202ULL, 2542286397227582385ULL, 17910920930800835566ULL, 11084893600486527060ULL, 12040054947452418920ULL, 16954682630191060769ULL, 12701525341189308756ULL, 8705642971550188078ULL, 1270934356161875985ULL, 9161384431223931149ULL, 3295953231915050114ULL, 9495928444634759150ULL, 14471233643876311445ULL, 11743176281107040778ULL, 1157576931411790723ULL, 1351022554057381010ULL, 15654497522815450168ULL, 15596083846782157315ULL, 1619836206092341657ULL, 269468296888261626ULL, 11610344679111727573ULL, 14219259687439715590ULL, 4899857898985763749ULL, 16599342878468561509ULL, 13610989912004846955ULL, 5498930314710104633ULL, 12874985769411275323ULL, 14100637875542297370ULL, 2466531037541086642ULL, 3999110633058906306ULL, 3548711125109269170ULL, 16341307074128935558ULL, 9131822247971587526ULL, 11165780462286449975ULL, 4080446744692131855ULL, 11668739542541274627ULL, 2770844723505070599ULL, 5316234222833021038ULL, 16962301081265320392ULL };
     static constexpr Shift BISHOP_SHIFTS[64] = { 58, 59, 59, 59, 59, 59, 59, 58, 59, 59, 59, 59, 59, 59, 60, 60, 59, 59, 57, 57, 57, 57, 59, 59, 59, 59, 57, 54, 54, 56, 59, 59, 59, 59, 56, 54, 54, 56, 59, 59, 59, 59, 56, 56, 56, 56, 59, 59, 59, 60, 59, 59, 59, 59, 59, 60, 58, 59, 59, 59, 59, 59, 59, 58 };
 
-    static inline utils::ragged_array2d<Bitboard, 64> ROOK_LOOKUP_TABLES = {};
-    static inline utils::ragged_array2d<Bitboard, 64> BISHOP_LOOKUP_TABLES = {};
+    static constexpr size_t ROOK_TABLE_SIZE = 278528; // Sum of the rook table sizes (1 << (64 - shift)) over all squares
+    static constexpr size_t BISHOP_TABLE_SIZE = 8128;  // Sum of the bishop table sizes (1 << (64 - shift)) over all squares
+
+    static constexpr size_t ROOK_PEXT_TABLE_SIZE = 102400; // Sum of the rook table sizes (1 << mask bits) over all squares
+    static constexpr size_t BISHOP_PEXT_TABLE_SIZE = 5248; // Sum of the bishop table sizes (1 << mask bits) over all squares
 
-  public:
     /**
-     * @brief Initializes the magic move generation lookup tables
+     * @brief The attacks of every square and blocker configuration of both sliders, in a single cache line aligned
+     *        block (rook tables first), where each square's table starts at its offset
      */
-    static void init();
+    template <size_t Size>
+    struct AttackTables
+    {
+      alignas(64) std::array<Bitboard, Size> attacks = {};
+      std::array<uint32_t, 64> rookOffsets = {};
+      std::array<uint32_t, 64> bishopOffsets = {};
+    };
+
+    typedef AttackTables<ROOK_TABLE_SIZE + BISHOP_TABLE_SIZE> MagicAttackTables;
+    typedef AttackTables<ROOK_PEXT_TABLE_SIZE + BISHOP_PEXT_TABLE_SIZE> PextAttackTables;
+
+    static const MagicAttackTables MAGIC_ATTACK_TABLES; // Indexed by the magic multiplication of the masked blockers
+#ifdef TUNGSTENCHESS_X86
+    static const PextAttackTables PEXT_ATTACK_TABLES; // Indexed by the masked blockers compressed with PEXT (only used with BMI2)
+#endif
+
+    typedef Bitboard (*SliderMovesFunction)(Square square, Bitboard allPieces);
 
+    /**
+     * @brief The slider move generation functions, selected once at startup for the running CPU
+     */
+    struct SliderKernels
+    {
+      SliderMovesFunction bishopMoves;
+      SliderMovesFunction rookMoves;
+    };
+
+    static SliderKernels s_sliderKernels;
+    static const bool s_sliderKernelsSelected;
+
+  public:
     /**
      * @brief Gets the bishop moves bitboard for a given square and pieces bitboard
      * @param square The square to get moves for
      * @param allPieces The blockers to be used for the calculation (these are unmasked)
      */
-    static Bitboard getBishopMoves(Square square, Bitboard allPieces);
+    static Bitboard getBishopMoves(Square square, Bitboard allPieces) { return s_sliderKernels.bishopMoves(square, allPieces); }
 
     /**
      * @brief Gets the rook moves bitboard for a given square and pieces bitboard
      * @param square The square to get moves for
      * @param allPieces The blockers to be used for the calculation (these are unmasked)
      */
-    static Bitboard getRookMoves(Square square, Bitboard allPieces);
+    static Bitboard getRookMoves(Square square, Bitboard allPieces) { return s_sliderKernels.rookMoves(square, allPieces); }
 
   private:
-    /**
-     * @brief Gets all possible blocker bitboards for a given square and mask
-     * @param blockers The vector to store the blockers in
-     * @param mask The mask to get blockers for
-     */
-    static void getAllBlockers(std::vector<Bitboard>& blockers, Bitboard mask);
+    static Bitboard getBishopMagicMoves(Square square, Bitboard allPieces);
+    static Bitboard getRookMagicMoves(Square square, Bitboard allPieces);
 
-    /**
-     * @brief Gets all possible shifted blocker bitboards for a given square, magic number, shift, and blockers
-     * @param blockers The blocker bitboards to be shifted (in place)
-     * @param magic The magic number to be used for the calculation
-     * @param shift The shift to be used for the calculation
-     * @param square The square to get shifted blockers for
-     */
-    static void shiftBlockers(std::vector<Bitboard>& blockers, Magic magic, Shift shift, Square square);
-
-    /**
-     * @brief Gets the rook moves bitboard for a given square and blockers
-     * @param square The square to get moves for
-     * @param blockers The blockers to be used for the calculation
-     */
-    static Bitboard getRookMovesBitboard(Square square, Bitboard blockers);
+#ifdef TUNGSTENCHESS_X86
+    static Bitboard getBishopPextMoves(Square square, Bitboard allPieces);
+    static Bitboard getRookPextMoves(Square square, Bitboard allPieces);
+#endif
 
     /**
-     * @brief Gets the bishop moves bitboard for a given square and blockers
-     * @param square The square to get moves for
-     * @param blockers The blockers to be used for the calculation
+     * @brief Upgrades the slider kernels to the fastest ones the running CPU supports
+     * @return Always true, so it can be used as a static initializer
      */
-    static Bitboard getBishopMovesBitboard(Square square, Bitboard blockers);
+    static bool selectSliderKernels();
 
     /**
-     * @brief Initializes the rook lookup tables
+     * @brief Fills a slider's tables with the moves of every subset of each square's blocker mask, stopping at (and including)
+     *        the nearest blocker in each direction
+     * @param tables The tables to be filled
+     * @param offsets The offset of each square's table, filled as the tables are laid out
+     * @param start The offset of the slider's first table
+     * @param masks The blocker masks of the slider
+     * @param magics The magic numbers of the slider (unused if pextIndexed)
+     * @param shifts The shifts of the slider (unused if pextIndexed)
+     * @param directions The directions of the slider, see MovesLookup
+     * @param pextIndexed Whether the tables are indexed by PEXT (the blockers' index in the enumeration of the mask's subsets)
      */
-    static void initRookLookupTables();
+    template <size_t Size>
+    static constexpr void generateSliderTables(AttackTables<Size>& tables, std::array<uint32_t, 64>& offsets, uint32_t start,
+                                               const MovesLookup::SquareTable& masks, const Magic (&magics)[64], const Shift (&shifts)[64],
+                                               const int (&directions)[4], bool pextIndexed);
 
-    /**
-     * @brief Initializes the bishop lookup tables
-     */
-    static void initBishopLookupTables();
+    template <typename Tables>
+    static constexpr Tables generateAttackTables(bool pextIndexed);
   };
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "utils/types.hpp"
+
+namespace TungstenChess
+{
+  /**
+   * @brief The first layer of the NNUE for both perspectives (0 for white, 1 for black), kept by the board and updated
+   *        as pieces move. A perspective marked dirty is stale (its king moved or the network was just loaded) and must
+   *        be refreshed before use. The network itself and the inference are in bot/nnue.hpp
+   */
+  struct NNUEAccumulator
+  {
+    static constexpr int HIDDEN_SIZE = 256;
+    static constexpr int INPUT_SIZE = 64 * 10 * 64; // King squares * non-king pieces * squares
+
+    alignas(64) std::array<std::array<int16_t, HIDDEN_SIZE>, 2> values;
+    std::array<bool, 2> dirty = { true, true };
+
+    /**
+     * @brief Gets the HalfKP input feature index of a piece from a perspective
+     * @param perspective The perspective (0 for white, 1 for black)
+     * @param kingIndex The square of the perspective's king
+     * @param piece The non-king piece
+     * @param square The square of the piece
+     */
+    static constexpr int getFeatureIndex(int perspective, Square kingIndex, Piece piece, Square square)
+    {
+      PieceColor perspectiveColor = perspective ? BLACK : WHITE;
+
+      // Squares are oriented so that the perspective's back rank is always 0-7 (the board itself has A8 = 0)
+      Square orientation = perspective ? 0 : 56;
+
+      int pieceIndex = (piece & TYPE) - PAWN + ((piece & COLOR) == perspectiveColor ? 0 : 5);
+
+      return ((kingIndex ^ orientation) * 10 + pieceIndex) * 64 + (square ^ orientation);
+    }
+  };
+}
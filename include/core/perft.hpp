@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "core/board.hpp"
+
+namespace TungstenChess
+{
+  /**
+   * @brief Counts the leaf nodes of the legal move tree (perft), splitting the root moves across threads
+   *        that each search their own branch of the board and share a lock-free hash table of subtree counts
+   */
+  class Perft
+  {
+  private:
+    /**
+     * @brief A hash table slot. The key is stored XORed with the count, so a torn write from another thread
+     *        fails verification on probe instead of returning a mismatched count
+     */
+    struct Entry
+    {
+      std::atomic<uint64_t> keyXorCount;
+      std::atomic<uint64_t> count;
+    };
+
+    const int m_threadCount;
+
+    const size_t ENTRY_COUNT;
+    std::unique_ptr<Entry[]> m_entries;
+
+  public:
+    /**
+     * @brief Constructs a perft runner
+     * @param threadCount The number of threads to split the root moves across
+     * @param hashSizeMB The size of the hash table in megabytes (0 to disable hashing)
+     */
+    Perft(int threadCount = std::thread::hardware_concurrency(), size_t hashSizeMB = 64);
+
+    /**
+     * @brief Counts the leaf nodes of the legal move tree from a position to a given depth
+     * @param board The position to count from
+     * @param depth The depth to count to
+     * @param verbose Whether to print the count after each root move (divide) and a nodes per second summary
+     */
+    uint64_t run(const Board& board, int depth, bool verbose = true);
+
+  private:
+    /**
+     * @brief Counts the leaf nodes below the current position of a board
+     * @param board The board to count on
+     * @param moveStack The auxiliary move stack to use for storing generated moves
+     * @param depth The depth to count to
+     */
+    uint64_t countNodes(Board& board, MoveStack& moveStack, int depth);
+
+    /**
+     * @brief Combines a position's Zobrist key with the remaining depth, since the same position is counted to different depths
+     */
+    static ZobristKey getHashKey(ZobristKey key, int depth) { return key ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ULL); }
+
+    Entry& entry(ZobristKey hashKey) const { return m_entries[(unsigned __int128)hashKey * ENTRY_COUNT >> 64]; }
+
+    bool probe(ZobristKey hashKey, uint64_t& count) const;
+    void store(ZobristKey hashKey, uint64_t count);
+  };
+}
@@ -1,39 +1,158 @@
 #pragma once
 
+#include <array>
+
+#include "core/move.hpp"
 #include "utils/types.hpp"
 #include "utils/utils.hpp"
 
+#define ZOBRIST_SEED 0x5EEDC0FFEE1234ULL
+
 namespace TungstenChess
 {
   typedef uint64_t ZobristKey;
   typedef utils::auxiliary_stack<ZobristKey> ZobristKeyStack;
 
-  class Zobrist
+  /**
+   * @brief Compile time generation of the Zobrist keys. Every key is derived from the fixed seed alone, so hashes
+   *        (and therefore search behavior) are identical between runs and builds, and nothing is initialized at startup
+   */
+  namespace ZobristGenerator
   {
-  public:
+    constexpr int PIECE_KEY_ROWS = 13; // NO_PIECE followed by the white and the black pieces, see pieceKeyRow
+
+    constexpr int CASTLING_KEYS_OFFSET = PIECE_KEY_ROWS * 64;
+    constexpr int EN_PASSANT_KEYS_OFFSET = CASTLING_KEYS_OFFSET + 16;
+    constexpr int SIDE_KEY_OFFSET = EN_PASSANT_KEYS_OFFSET + 9;
+
+    constexpr int CUCKOO_TABLE_SIZE = 8192; // Must be a power of 2, holding the 3668 reversible moves with room to spare
+
     /**
-     * @brief Populates the pieceKeys, castlingKeys, enPassantKeys, and sideKey vectors with random keys
+     * @brief Gets the row of a piece in the dense piece key table: 0 for NO_PIECE, 1-6 for white and 7-12 for black pieces
      */
-    static void init();
+    constexpr int pieceKeyRow(Piece piece) { return (piece >> 4) * 6 + (piece & TYPE); }
+
+    /**
+     * @brief Gets the n-th key of the SplitMix64 sequence starting at the seed
+     */
+    constexpr ZobristKey randomKey(uint64_t index)
+    {
+      uint64_t z = ZOBRIST_SEED + (index + 1) * 0x9E3779B97F4A7C15ULL;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    }
+
+    constexpr std::array<std::array<ZobristKey, 64>, PIECE_KEY_ROWS> generatePieceKeys()
+    {
+      std::array<std::array<ZobristKey, 64>, PIECE_KEY_ROWS> pieceKeys = {};
+
+      // NO_PIECE keeps zero keys, so that empty squares do not contribute to the key
+      for (int row = 1; row < PIECE_KEY_ROWS; row++)
+        for (int square = 0; square < 64; square++)
+          pieceKeys[row][square] = randomKey(row * 64 + square);
+
+      return pieceKeys;
+    }
+
+    template <size_t N>
+    constexpr std::array<ZobristKey, N> generateKeys(int offset)
+    {
+      std::array<ZobristKey, N> keys = {};
+
+      for (size_t i = 0; i < N; i++)
+        keys[i] = randomKey(offset + i);
+
+      return keys;
+    }
+
+    constexpr int cuckooIndex1(ZobristKey key) { return key & (CUCKOO_TABLE_SIZE - 1); }
+    constexpr int cuckooIndex2(ZobristKey key) { return (key >> 16) & (CUCKOO_TABLE_SIZE - 1); }
+
+    struct CuckooTables
+    {
+      std::array<ZobristKey, CUCKOO_TABLE_SIZE> keys = {};
+      std::array<Move, CUCKOO_TABLE_SIZE> moves = {};
+    };
 
-  private:
     /**
-     * @brief Get the combined Zobrist key for two pieces on the same square
-     *        (used for updating the hash for a single square)
-     * @param square The square to get the key for
-     * @param before The piece that was on the square before
-     * @param after The piece that is on the square now
+     * @brief Builds the cuckoo tables of every reversible move of a non-pawn piece, keyed by the change it makes
+     *        to the Zobrist key (including the side to move), so that a key difference can be mapped back to a move
      */
-    static ZobristKey getPieceCombinationKey(Square square, Square before, Square after);
+    constexpr CuckooTables generateCuckooTables()
+    {
+      CuckooTables tables;
 
-    static inline utils::array2d<ZobristKey, PIECE_NUMBER, 64> pieceKeys = {};
-    static inline std::array<ZobristKey, 16> castlingKeys = {};
-    static inline std::array<ZobristKey, 9> enPassantKeys = {};
-    static inline ZobristKey sideKey = 0;
+      for (int row = 1; row < PIECE_KEY_ROWS; row++)
+      {
+        PieceType pieceType = (row - 1) % 6 + 1;
 
-    static inline std::array<ZobristKey, 64 * 32 * 32> precomputedPieceCombinationKeys = {};
+        if (pieceType == PAWN)
+          continue;
+
+        for (int from = 0; from < 64; from++)
+        {
+          for (int to = from + 1; to < 64; to++)
+          {
+            int rankDistance = from / 8 > to / 8 ? from / 8 - to / 8 : to / 8 - from / 8;
+            int fileDistance = from % 8 > to % 8 ? from % 8 - to % 8 : to % 8 - from % 8;
+
+            bool isDiagonal = rankDistance == fileDistance;
+            bool isOrthogonal = rankDistance == 0 || fileDistance == 0;
+
+            bool isReachable = (pieceType == KNIGHT && rankDistance * fileDistance == 2) ||
+                               (pieceType == BISHOP && isDiagonal) ||
+                               (pieceType == ROOK && isOrthogonal) ||
+                               (pieceType == QUEEN && (isDiagonal || isOrthogonal)) ||
+                               (pieceType == KING && rankDistance <= 1 && fileDistance <= 1);
+
+            if (!isReachable)
+              continue;
+
+            Move move = from | (to << 6);
+            ZobristKey key = randomKey(row * 64 + from) ^ randomKey(row * 64 + to) ^ randomKey(SIDE_KEY_OFFSET);
+
+            // Cuckoo insertion - each key lives in one of its two slots, evicting the occupant into its other slot
+            int index = cuckooIndex1(key);
+            while (true)
+            {
+              ZobristKey evictedKey = tables.keys[index];
+              Move evictedMove = tables.moves[index];
+
+              tables.keys[index] = key;
+              tables.moves[index] = move;
+
+              if (evictedMove == NULL_MOVE)
+                break;
+
+              key = evictedKey;
+              move = evictedMove;
+              index = index == cuckooIndex1(key) ? cuckooIndex2(key) : cuckooIndex1(key);
+            }
+          }
+        }
+      }
+
+      return tables;
+    }
+  }
+
+  class Zobrist
+  {
+  private:
+    static constexpr std::array<std::array<ZobristKey, 64>, ZobristGenerator::PIECE_KEY_ROWS> pieceKeys = ZobristGenerator::generatePieceKeys();
+    static constexpr std::array<ZobristKey, 16> castlingKeys = ZobristGenerator::generateKeys<16>(ZobristGenerator::CASTLING_KEYS_OFFSET);
+    static constexpr std::array<ZobristKey, 9> enPassantKeys = ZobristGenerator::generateKeys<9>(ZobristGenerator::EN_PASSANT_KEYS_OFFSET);
+    static constexpr ZobristKey sideKey = ZobristGenerator::randomKey(ZobristGenerator::SIDE_KEY_OFFSET);
+
+    static constexpr ZobristGenerator::CuckooTables cuckooTables = ZobristGenerator::generateCuckooTables();
+
+    /**
+     * @brief Gets the key of a piece on a square (0 for NO_PIECE)
+     */
+    static ZobristKey pieceKey(Piece piece, Square square) { return pieceKeys[ZobristGenerator::pieceKeyRow(piece)][square]; }
 
     friend class Board;
     friend class OpeningBook;
   };
-}
\ No newline at end of file
+}
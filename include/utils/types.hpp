@@ -12,6 +12,8 @@ namespace TungstenChess
   typedef uint8_t PieceColor;
   typedef uint8_t PieceType;
 
+  typedef int32_t Score; // A packed midgame and endgame evaluation, see makeScore
+
   typedef uint8_t Square;
   typedef uint8_t Rank;
   typedef uint8_t File;
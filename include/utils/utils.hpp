@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <mutex>
@@ -106,130 +108,6 @@ namespace TungstenChess
       bool value = false;
     };
 
-    /**
-     * @brief A 2D array implementation using a flat heap allocation to reduce memory fragmentation.
-     *        This is useful for storing large 2D arrays in contiguous heap memory.
-     * @tparam T The type of the elements in the array.
-     * @tparam R The number of rows in the array.
-     * @tparam C The number of columns in the array.
-     */
-    template <typename T, size_t R, size_t C>
-    struct array2d
-    {
-      array2d()
-          : m_data(new T[R * C])
-      {}
-
-      ~array2d()
-      {
-        delete[] m_data;
-      }
-
-      /**
-       * @brief Access an element in the array using row and column indices.
-       * @param r The row index.
-       * @param c The column index.
-       * @return A reference to the element at the specified row and column.
-       */
-      T& at(size_t r, size_t c)
-      {
-        return m_data[r * C + c];
-      }
-
-      /**
-       * @brief Access an element in the array using row and column indices.
-       * @param r The row index.
-       * @param c The column index.
-       * @return A const reference to the element at the specified row and column.
-       */
-      const T& at(size_t r, size_t c) const
-      {
-        return m_data[r * C + c];
-      }
-
-      /**
-       * @brief Copy a row from another array2d to this array2d.
-       * @param other The other array2d to copy from.
-       * @param src The source row index in the other array2d.
-       * @param dst The destination row index in this array2d.
-       * @note If the source and destination are the same, and other is the same as this, no operation is performed.
-       * @note If the source or destination indices are out of bounds, no operation is performed.
-       * @note If the two arrays have different column sizes, no operation is performed.
-       */
-      void copyRow(const array2d& other, size_t src, size_t dst)
-      {
-        if (this == &other && src == dst)
-          return;
-
-        if (src > other.m_rows || dst > R || other.m_cols != C)
-          return;
-
-        std::copy(&other.m_data[src * C], &other.m_data[src * C + C], &m_data[dst * C]);
-      }
-
-      /**
-       * @brief Copy a row from this array2d to itself.
-       * @param src The source row index in this array2d.
-       * @param dst The destination row index in this array2d.
-       * @note If the source and destination are the same, no operation is performed.
-       * @note If the source or destination indices are out of bounds, no operation is performed.
-       */
-      void copyRow(size_t src, size_t dst)
-      {
-        copyRow(*this, src, dst);
-      }
-
-    private:
-      T* m_data;
-      const size_t m_rows = R;
-      const size_t m_cols = C;
-    };
-
-    /**
-     * @brief A 2D ragged array implementation using a flat heap allocation to reduce memory fragmentation.
-    *         This is useful for storing 2D arrays with different row sizes in contiguous heap memory.
-     * @tparam T The type of the elements in the array.
-     * @tparam R The number of rows in the array.
-     */
-    template <typename T, size_t R>
-    struct ragged_array2d
-    {
-    private:
-      T* m_data;
-      std::array<size_t, R> m_rowOffsets;
-      size_t m_capacity;
-
-    public:
-      ragged_array2d() {}
-
-      ragged_array2d(std::array<size_t, R>& rowSizes)
-      {
-        reserve(rowSizes);
-      }
-
-      ~ragged_array2d()
-      {
-        delete[] m_data;
-      }
-
-      void reserve(std::array<size_t, R>& rowSizes)
-      {
-        size_t totalSize = 0;
-
-        for (size_t i = 0; i < R; i++)
-        {
-          m_rowOffsets[i] = totalSize;
-          totalSize += rowSizes[i];
-        }
-
-        m_capacity = totalSize;
-        m_data = new T[m_capacity];
-      }
-
-      T& at(size_t r, size_t c) { return m_data[m_rowOffsets[r] + c]; }
-      const T& at(size_t r, size_t c) const { return m_data[m_rowOffsets[r] + c]; }
-    };
-
     /**
      * @brief This class simulates stack memory, but is allocated on the heap. It supports
      *        dynamic top allocation, which can be used to allocate memory at the top of the stack
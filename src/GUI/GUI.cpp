@@ -26,6 +26,7 @@ ResourceManager::ResourceManager()
   std::filesystem::path resourcePath = getResourcePath();
 
   m_openingBookPath = resourcePath / "opening_book.dat";
+  m_nnuePath = resourcePath / "nnue.bin";
 
   m_yellowOutlineTexture.loadFromFile(resourcePath / "yellow_outline.png");
 
@@ -54,6 +55,9 @@ GUIHandler::GUIHandler()
   m_whiteBot.loadOpeningBook(m_resourceManager.m_openingBookPath);
   m_blackBot.loadOpeningBook(m_resourceManager.m_openingBookPath);
 
+  // The network is shared by every bot, and both bots play on the same board
+  m_whiteBot.loadNNUE(m_resourceManager.m_nnuePath);
+
   loadSquareTextures();
   loadBoardSquares();
 
@@ -52,6 +52,7 @@ private:
   }
 
   std::filesystem::path m_openingBookPath;
+  std::filesystem::path m_nnuePath;
 
   sf::Texture m_yellowOutlineTexture;
   sf::Texture m_pieceTextures[PIECE_NUMBER];
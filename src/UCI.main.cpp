@@ -1,34 +1,23 @@
-// UCI functionality is not currently supported/up to date.
-// Disregard this file for now.
-// This file is a placeholder for future UCI support.
-
+#include <condition_variable>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
-#ifdef __APPLE__
-#include <CoreFoundation/CoreFoundation.h>
-#endif
-
+#include "bot/bench.hpp"
 #include "bot/engine.hpp"
+#include "core/cpu_features.hpp"
+#include "core/perft.hpp"
 
 using namespace TungstenChess;
 
 std::filesystem::path getResourcePath()
 {
-#ifdef __APPLE__
-  CFBundleRef mainBundle = CFBundleGetMainBundle();
-  CFURLRef resourcesURL = CFBundleCopyResourcesDirectoryURL(mainBundle);
-  char path[PATH_MAX];
-  if (!CFURLGetFileSystemRepresentation(resourcesURL, TRUE, (UInt8*)path, PATH_MAX))
-  {
-    return "";
-  }
-  CFRelease(resourcesURL);
-  return path;
-#else
   return TUNGSTENCHESS_RESOURCES_DIR;
-#endif
 }
 
 std::vector<std::string> split(std::string str, std::string delimiter)
@@ -40,130 +29,422 @@ std::vector<std::string> split(std::string str, std::string delimiter)
   while ((pos = str.find(delimiter)) != std::string::npos)
   {
     token = str.substr(0, pos);
-    splitString.push_back(token);
+    if (!token.empty())
+      splitString.push_back(token);
     str.erase(0, pos + delimiter.length());
   }
-  splitString.push_back(str);
+  if (!str.empty())
+    splitString.push_back(str);
 
   return splitString;
 }
 
-int main()
+/**
+ * @brief Parses an integer sent by the GUI, clamping it to the range of the value
+ * @param str The string to parse
+ * @param value The value to set, left unchanged if the string is not an integer
+ * @param min The minimum of the value
+ * @return Whether the string was an integer
+ */
+template <typename T>
+bool parseInteger(const std::string& str, T& value, T min = std::numeric_limits<T>::min())
 {
-  Board board;
+  long long parsed;
+
+  try
+  {
+    size_t length;
+    parsed = std::stoll(str, &length);
+
+    if (length != str.size())
+      return false;
+  }
+  catch (const std::logic_error&) // std::invalid_argument or std::out_of_range
+  {
+    return false;
+  }
+
+  if (parsed < 0 && parsed < static_cast<long long>(min))
+    value = min;
+  else if (parsed > 0 && static_cast<unsigned long long>(parsed) > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+    value = std::numeric_limits<T>::max();
+  else
+    value = std::max(min, static_cast<T>(parsed));
+
+  return true;
+}
+
+/**
+ * @brief Runs searches on a separate thread, so that the input loop stays responsive to "stop" and "isready" while searching
+ */
+class UCISearchThread
+{
+private:
+  Bot& m_bot;
 
-  Bot bot(board);
+  std::thread m_thread;
 
-  std::filesystem::path openingBookPath = getResourcePath() / "opening_book.dat";
+  std::mutex m_stopMutex;
+  std::condition_variable m_stopEvent;
+  bool m_stopRequested = false;
 
-  bot.loadOpeningBook(openingBookPath);
+public:
+  UCISearchThread(Bot& bot)
+      : m_bot(bot)
+  {}
 
-  std::cout << "TungstenChess v1.0\n";
+  ~UCISearchThread() { stop(); }
 
-  while (true)
+  /**
+   * @brief Starts a search, printing "bestmove" when it completes
+   * @param searchLimits The limits of the search
+   * @param infinite Whether to hold back the best move until "stop" even if the search completes earlier (go infinite)
+   */
+  void start(const Bot::SearchLimits& searchLimits, bool infinite)
   {
-    std::string input;
-    std::getline(std::cin, input);
+    wait();
+
+    m_stopRequested = false;
+    m_bot.clearStopRequest();
+
+    m_thread = std::thread(
+        [this, searchLimits, infinite]()
+        {
+          Move bestMove = m_bot.generateBotMove(searchLimits);
+
+          if (infinite)
+          {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            m_stopEvent.wait(lock, [this]
+                             { return m_stopRequested; });
+          }
 
-    if (input == "quit")
+          if (bestMove == NULL_MOVE)
+            std::cout << "bestmove 0000" << std::endl;
+          else
+            std::cout << "bestmove " << Moves::getUCI(bestMove) << std::endl;
+        }
+    );
+  }
+
+  /**
+   * @brief Stops the running search (if any) and waits for it to print its best move
+   */
+  void stop()
+  {
     {
-      break;
+      std::lock_guard<std::mutex> lock(m_stopMutex);
+      m_stopRequested = true;
     }
+    m_stopEvent.notify_one();
 
-    if (input == "uci")
+    m_bot.stopSearch();
+
+    wait();
+  }
+
+  /**
+   * @brief Waits for the running search (if any) to complete on its own
+   */
+  void wait()
+  {
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+};
+
+void printBoard(const Board& board)
+{
+  std::cout << "\n";
+  for (int i = 0; i < 64; i++)
+  {
+    if (i % 8 == 0)
     {
-      std::cout << "id name TungstenChess" << std::endl
-                << "id author Pradyun Gaddam" << std::endl
-                << "uciok" << std::endl;
-      continue;
+      std::cout << " +---+---+---+---+---+---+---+---+\n ";
     }
 
-    if (input == "isready")
+    std::cout << "| "
+              << " ........PNBRQK..pnbrqk"[board[i]] << " ";
+
+    if (i % 8 == 7)
     {
-      std::cout << "readyok" << std::endl;
-      continue;
+      std::cout << "| " << 8 - (i >> 3) << "\n";
     }
+  }
 
-    if (input == "ucinewgame")
+  std::cout << " +---+---+---+---+---+---+---+---+\n";
+  std::cout << "   a   b   c   d   e   f   g   h\n\n";
+
+  std::cout << "Side to move: " << (board.sideToMove() == WHITE ? "White" : "Black") << "\n";
+  std::cout << "Zobrist key: " << board.zobristKey() << std::endl;
+}
+
+void printEvalFileStatus(const std::filesystem::path& evalFile)
+{
+  if (NNUE::isLoaded())
+    std::cout << "info string NNUE network loaded from " << evalFile.string() << std::endl;
+  else
+    std::cout << "info string No valid NNUE network at " << evalFile.string() << ", using the handcrafted evaluation" << std::endl;
+}
+
+void loadEvalFile(Bot& bot, std::filesystem::path& evalFile, const std::filesystem::path& path)
+{
+  if (!bot.loadNNUE(path) && NNUE::isLoaded())
+  {
+    std::cout << "info string No valid NNUE network at " << path.string() << ", keeping the network from " << evalFile.string() << std::endl;
+    return;
+  }
+
+  evalFile = path;
+  printEvalFileStatus(evalFile);
+}
+
+void setOption(Bot& bot, std::filesystem::path& evalFile, const std::vector<std::string>& splitInput)
+{
+  std::string name, value;
+  std::string* current = nullptr;
+
+  for (size_t i = 1; i < splitInput.size(); i++)
+  {
+    if (splitInput[i] == "name")
+      current = &name;
+    else if (splitInput[i] == "value")
+      current = &value;
+    else if (current)
+      *current += (current->empty() ? "" : " ") + splitInput[i];
+  }
+
+  if (name == "EvalFile")
+  {
+    loadEvalFile(bot, evalFile, value);
+    return;
+  }
+
+  Bot::BotSettings settings = bot.botSettings();
+
+  bool valid = true;
+
+  if (name == "Hash")
+    valid = parseInteger(value, settings.transpositionTableSizeMB, 1);
+  else if (name == "Threads")
+    valid = parseInteger(value, settings.searchThreads, 1);
+  else if (name == "OwnBook")
+    settings.useOpeningBook = value == "true";
+  else if (name == "Move Overhead")
+    valid = parseInteger(value, settings.moveOverhead, 0);
+  else
+    return;
+
+  if (!valid)
+    return;
+
+  bot.setBotSettings(settings);
+}
+
+void setPosition(Board& board, Bot& bot, const std::vector<std::string>& splitInput)
+{
+  size_t movesIndex = splitInput.size();
+
+  for (size_t i = 1; i < splitInput.size(); i++)
+  {
+    if (splitInput[i] == "moves")
     {
-      board.resetBoard();
-      continue;
+      movesIndex = i;
+      break;
     }
+  }
+
+  if (splitInput.size() > 1 && splitInput[1] == "fen")
+  {
+    std::string fen = "";
+    for (size_t i = 2; i < movesIndex; i++)
+      fen += (i > 2 ? " " : "") + splitInput[i];
 
-    if (input == "d")
+    board.resetBoard(fen);
+  }
+  else
+    board.resetBoard();
+
+  bot.resetOpeningBook();
+
+  for (size_t i = movesIndex + 1; i < splitInput.size(); i++)
+  {
+    Move move = board.generateMoveFromUCI(splitInput[i]);
+
+    board.makeMove(move);
+    bot.addMove(move);
+  }
+}
+
+Bot::SearchLimits parseSearchLimits(const Board& board, const std::vector<std::string>& splitInput, bool& infinite)
+{
+  Bot::SearchLimits searchLimits;
+
+  infinite = false;
+
+  for (size_t i = 1; i < splitInput.size(); i++)
+  {
+    const std::string& token = splitInput[i];
+    bool hasValue = i + 1 < splitInput.size();
+
+    if (token == "infinite")
+      infinite = true;
+    else if (!hasValue)
+      continue;
+    else if (token == (board.sideToMove() == WHITE ? "wtime" : "btime"))
+      parseInteger(splitInput[++i], searchLimits.timeLeft, 0);
+    else if (token == (board.sideToMove() == WHITE ? "winc" : "binc"))
+      parseInteger(splitInput[++i], searchLimits.increment, 0);
+    else if (token == "movestogo")
+      parseInteger(splitInput[++i], searchLimits.movesToGo, 0);
+    else if (token == "depth")
+      parseInteger(splitInput[++i], searchLimits.maxDepth, 1);
+    else if (token == "nodes")
+      parseInteger(splitInput[++i], searchLimits.maxNodes);
+    else if (token == "movetime")
+      parseInteger(splitInput[++i], searchLimits.maxSearchTime, 0);
+  }
+
+  return searchLimits;
+}
+
+int main(int argc, char** argv)
+{
+  // "TungstenChessUCI bench [depth]" runs the benchmark and exits, for scripted regression checks
+  if (argc > 1 && std::string(argv[1]) == "bench")
+  {
+    int depth = Bench::DEFAULT_DEPTH;
+    if (argc > 2)
+      parseInteger(argv[2], depth, 1);
+
+    Bench::run(depth);
+    return 0;
+  }
+
+  // "TungstenChessUCI nnuecheck [plies]" checks the NNUE accumulator updates with a random network and exits (1 on a mismatch)
+  if (argc > 1 && std::string(argv[1]) == "nnuecheck")
+  {
+    int plies = Bench::NNUE_CHECK_PLIES;
+    if (argc > 2)
+      parseInteger(argv[2], plies, 1);
+
+    return Bench::checkNNUE(plies) ? 0 : 1;
+  }
+
+  Board board;
+
+  Bot::BotSettings settings;
+  settings.logSearchInfo = false;
+  settings.logUCIInfo = true;
+
+  Bot bot(board, settings);
+
+  bot.loadOpeningBook(getResourcePath() / "opening_book.dat");
+
+  std::filesystem::path evalFile = getResourcePath() / "nnue.bin";
+
+  bot.loadNNUE(evalFile);
+
+  UCISearchThread searchThread(bot);
+
+  std::string input;
+  while (std::getline(std::cin, input))
+  {
+    std::vector<std::string> splitInput = split(input, " ");
+
+    if (splitInput.empty())
+      continue;
+
+    const std::string& command = splitInput[0];
+
+    if (command == "quit")
+      break;
+
+    if (command == "uci")
     {
-      std::cout << "\n";
-      for (int i = 0; i < 64; i++)
-      {
-        if (i % 8 == 0)
-        {
-          std::cout << " +---+---+---+---+---+---+---+---+\n ";
-        }
+      const Bot::BotSettings& defaultSettings = bot.botSettings();
 
-        std::cout << "| "
-                  << " ........PNBRQK..pnbrqk"[board[i]] << " ";
+      std::cout << "id name TungstenChess\n"
+                << "id author Pradyun Gaddam\n"
+                << "option name Hash type spin default " << defaultSettings.transpositionTableSizeMB << " min 1 max 65536\n"
+                << "option name Threads type spin default " << defaultSettings.searchThreads << " min 1 max 256\n"
+                << "option name OwnBook type check default " << (defaultSettings.useOpeningBook ? "true" : "false") << "\n"
+                << "option name Move Overhead type spin default " << defaultSettings.moveOverhead << " min 0 max 5000\n"
+                << "option name EvalFile type string default " << evalFile.string() << "\n"
+                << "uciok" << std::endl;
 
-        if (i % 8 == 7)
-        {
-          std::cout << "| " << 8 - (i >> 3) << "\n";
-        }
-      }
+      // Reported after the handshake, as GUIs may not expect any output before "uci"
+      std::cout << "info string TungstenChess v1.0 (cpu features: " << CpuFeatures::describe() << ")" << std::endl;
+      printEvalFileStatus(evalFile);
+    }
+
+    else if (command == "isready")
+      std::cout << "readyok" << std::endl;
 
-      std::cout << " +---+---+---+---+---+---+---+---+\n";
-      std::cout << "   a   b   c   d   e   f   g   h\n\n";
+    else if (command == "stop")
+      searchThread.stop();
 
-      std::cout << "Side to move: " << (board.sideToMove() == WHITE ? "White" : "Black") << "\n";
-      std::cout << "Zobrist key: " << board.zobristKey() << "\n";
+    else if (command == "setoption")
+    {
+      searchThread.stop();
+      setOption(bot, evalFile, splitInput);
     }
 
-    std::vector<std::string> splitInput = split(input, " ");
+    else if (command == "ucinewgame")
+    {
+      searchThread.stop();
+      board.resetBoard();
+      bot.resetOpeningBook();
+      bot.clearTranspositionTable();
+    }
 
-    if (splitInput[0] == "go")
+    else if (command == "position")
     {
-      Move bestMove = bot.generateBotMove();
-      std::cout << "bestmove " << Moves::getUCI(bestMove) << "\n";
+      searchThread.stop();
+      setPosition(board, bot, splitInput);
+    }
+
+    else if (command == "go" && splitInput.size() > 2 && splitInput[1] == "perft")
+    {
+      searchThread.stop();
 
-      if (splitInput[1] == "move")
+      int depth;
+      if (parseInteger(splitInput[2], depth, 1))
       {
-        board.makeMove(bestMove);
+        Perft perft(bot.botSettings().searchThreads);
+        perft.run(board, depth);
       }
+    }
 
-      continue;
+    else if (command == "go")
+    {
+      searchThread.stop();
+
+      bool infinite;
+      Bot::SearchLimits searchLimits = parseSearchLimits(board, splitInput, infinite);
+
+      searchThread.start(searchLimits, infinite);
     }
 
-    if (splitInput[0] == "position")
+    else if (command == "bench")
     {
-      if (splitInput[1] == "startpos")
-      {
-        board.resetBoard();
-      }
-      else if (splitInput[1] == "fen")
-      {
-        std::string fen = "";
-        for (int i = 2; i < splitInput.size(); i++)
-        {
-          fen += splitInput[i] + " ";
-        }
-        board.resetBoard(fen);
-      }
+      searchThread.stop();
 
-      if (splitInput.size() > 2 && splitInput[2] == "moves")
-      {
-        for (int i = 3; i < splitInput.size(); i++)
-        {
-          board.makeMove(board.generateMoveFromUCI(splitInput[i]));
-        }
-      }
+      int depth = Bench::DEFAULT_DEPTH;
+      if (splitInput.size() > 1)
+        parseInteger(splitInput[1], depth, 1);
+
+      Bench::run(depth);
     }
 
-    if (splitInput[0] == "moves")
+    else if (command == "d")
     {
-      for (int i = 1; i < splitInput.size(); i++)
-      {
-        board.makeMove(board.generateMoveFromUCI(splitInput[i]));
-      }
+      searchThread.stop();
+      printBoard(board);
     }
   }
 
+  searchThread.stop();
+
   return 0;
-}
\ No newline at end of file
+}
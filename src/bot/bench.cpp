@@ -0,0 +1,160 @@
+#include "bot/bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bot/engine.hpp"
+
+namespace TungstenChess
+{
+  uint64_t Bench::run(int depth, bool verbose)
+  {
+    Bot::BotSettings settings;
+    settings.useOpeningBook = false;
+    settings.logSearchInfo = false;
+    settings.logUCIInfo = false;
+    settings.searchThreads = 1;
+    settings.transpositionTableSizeMB = TRANSPOSITION_TABLE_SIZE_MB;
+
+    Bot::SearchLimits searchLimits;
+    searchLimits.maxDepth = depth;
+
+    uint64_t totalNodes = 0;
+    std::chrono::high_resolution_clock::duration totalTime(0);
+
+    for (size_t i = 0; i < FENS.size(); i++)
+    {
+      // A fresh board and bot for every position, so that no state carries over from the previous search
+      Board board(FENS[i]);
+      Bot bot(board, settings);
+
+      auto start = std::chrono::high_resolution_clock::now();
+
+      bot.generateBotMove(searchLimits);
+
+      totalTime += std::chrono::high_resolution_clock::now() - start;
+
+      uint64_t nodes = bot.getNodesSearched();
+      totalNodes += nodes;
+
+      if (verbose)
+        std::cout << "Position " << i + 1 << "/" << FENS.size() << ": " << nodes << " nodes" << std::endl;
+    }
+
+    if (verbose)
+    {
+      int64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(totalTime).count();
+
+      std::cout << "\nNodes searched: " << totalNodes
+                << "\nTime: " << time << " ms"
+                << "\nNodes per second: " << totalNodes * 1000 / std::max<int64_t>(time, 1)
+                << std::endl;
+    }
+
+    return totalNodes;
+  }
+
+  bool Bench::checkNNUE(int plies, bool verbose)
+  {
+    NNUE::generateRandomNetwork(NNUE_CHECK_SEED);
+
+    std::mt19937_64 random(NNUE_CHECK_SEED);
+    MoveStack moveStack(MAX_LEGAL_MOVE_COUNT);
+
+    uint64_t evaluationsChecked = 0;
+    uint64_t mismatches = 0;
+
+    // Compares the board's incrementally updated evaluation with that of a copy whose accumulator is rebuilt from scratch
+    auto check = [&](Board& board, size_t fenIndex, size_t ply)
+    {
+      Board refreshed = board.createBranch(0);
+      refreshed.resetAccumulator();
+
+      int incrementalEvaluation = board.getNNUEEvaluation();
+      int refreshedEvaluation = refreshed.getNNUEEvaluation();
+
+      evaluationsChecked++;
+
+      if (incrementalEvaluation == refreshedEvaluation)
+        return;
+
+      if (verbose && mismatches == 0)
+        std::cout << "Mismatch in position " << fenIndex + 1 << " at ply " << ply << ": incremental " << incrementalEvaluation
+                  << ", refreshed " << refreshedEvaluation << std::endl;
+
+      mismatches++;
+    };
+
+    // Makes and unmakes every king move, which must return to the parent's accumulator as it was rather than a stale one
+    auto checkKingMoves = [&](Board& board, const MoveAllocation& legalMoves, int legalMovesCount, size_t fenIndex, size_t ply)
+    {
+      board.getNNUEEvaluation();
+
+      for (int i = 0; i < legalMovesCount; i++)
+      {
+        Move move = legalMoves[i];
+
+        if ((board[move & FROM] & TYPE) != KING)
+          continue;
+
+        Board::UnmoveData unmoveData = board.makeMove(move);
+        board.getNNUEEvaluation();
+        board.unmakeMove(move, unmoveData);
+
+        if (board.accumulator().dirty[0] || board.accumulator().dirty[1])
+        {
+          if (verbose && mismatches == 0)
+            std::cout << "Stale accumulator in position " << fenIndex + 1 << " at ply " << ply << " after unmaking "
+                      << Moves::getUCI(move) << std::endl;
+
+          mismatches++;
+        }
+
+        check(board, fenIndex, ply);
+      }
+    };
+
+    for (size_t i = 0; i < FENS.size(); i++)
+    {
+      Board board(FENS[i]);
+
+      std::vector<Move> moves;
+      std::vector<Board::UnmoveData> unmoveData;
+
+      check(board, i, 0);
+
+      for (int ply = 0; ply < plies; ply++)
+      {
+        MoveAllocation legalMoves(moveStack);
+        int legalMovesCount = board.getLegalMoves(legalMoves);
+
+        if (legalMovesCount == 0)
+          break;
+
+        checkKingMoves(board, legalMoves, legalMovesCount, i, moves.size());
+
+        moves.push_back(legalMoves[random() % legalMovesCount]);
+        unmoveData.push_back(board.makeMove(moves.back()));
+
+        check(board, i, moves.size());
+      }
+
+      while (!moves.empty())
+      {
+        board.unmakeMove(moves.back(), unmoveData.back());
+        moves.pop_back();
+        unmoveData.pop_back();
+
+        check(board, i, moves.size());
+      }
+    }
+
+    if (verbose)
+      std::cout << "NNUE evaluations checked: " << evaluationsChecked << "\nMismatches: " << mismatches << std::endl;
+
+    return mismatches == 0;
+  }
+}
@@ -1,5 +1,7 @@
 #include "bot/engine.hpp"
 
+#include <cmath>
+
 namespace TungstenChess
 {
   Bot::Bot(Board& board, const BotSettings& settings)
@@ -7,14 +9,41 @@ namespace TungstenChess
         m_openingBook(board.zobristKey()),
         m_moveStack(AUXILIARY_MOVE_STACK_SIZE),
         m_botSettings(settings),
-        m_transpositionTable(m_botSettings.transpositionTableSizeMB)
+        m_transpositionTable(std::make_shared<TranspositionTable>(m_botSettings.transpositionTableSizeMB))
   {
+    initLateMoveReductions();
+    createHelpers();
     startSearchTimerThread();
   }
 
+  Bot::Bot(Board& board, const Bot& mainBot)
+      : m_board(board),
+        m_openingBook(board.zobristKey()),
+        m_moveStack(AUXILIARY_MOVE_STACK_SIZE),
+        m_botSettings(mainBot.m_botSettings),
+        m_transpositionTable(mainBot.m_transpositionTable)
+  {
+    // Only the main bot reports on the search
+    m_botSettings.logUCIInfo = false;
+  }
+
+  void Bot::initLateMoveReductions()
+  {
+    static utils::once<false> initialized;
+    if (initialized)
+      return;
+
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; depth++)
+      for (int moveNumber = 1; moveNumber < MAX_LEGAL_MOVE_COUNT; moveNumber++)
+        s_lateMoveReductions[depth][moveNumber] = 0.75 + std::log(depth) * std::log(moveNumber) / 2.25;
+  }
+
   Bot::~Bot()
   {
     stopSearchTimerThread();
+
+    m_helperBots.clear();
+    m_helperBoards.clear();
   }
 
   void Bot::loadOpeningBook(const std::filesystem::path path)
@@ -22,4 +51,14 @@ namespace TungstenChess
     if (!m_onceOpeningBookLoaded)
       m_openingBook.loadOpeningBook(path);
   }
+
+  bool Bot::loadNNUE(const std::filesystem::path path)
+  {
+    if (!NNUE::loadNetwork(path))
+      return false;
+
+    m_board.resetAccumulator();
+
+    return true;
+  }
 }
\ No newline at end of file
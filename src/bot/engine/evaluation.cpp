@@ -10,35 +10,23 @@ namespace TungstenChess
   {
     m_previousSearchInfo.positionsEvaluated++;
 
-    Board::GameStatus gameStatus = m_board.getGameStatus(m_board.sideToMove());
+    if (m_botSettings.useNNUE && NNUE::isLoaded())
+      return m_board.getNNUEEvaluation();
 
-    if (gameStatus != Board::NO_MATE)
-    {
-      if (gameStatus == Board::LOSE)
-        return -INF_EVAL;
-      else
-        return -CONTEMPT;
-    }
+    Score score = getPositionalEvaluation() + getEvaluationBonus();
 
     int staticEvaluation = 0;
     staticEvaluation += getMaterialEvaluation();
-    staticEvaluation += getPositionalEvaluation();
+    staticEvaluation += taperScore(score, m_board.phase());
     // staticEvaluation += getMobilityEvaluation();
-    staticEvaluation += getEvaluationBonus();
 
     return m_board.sideToMove() == WHITE ? staticEvaluation : -staticEvaluation;
   }
 
   int Bot::getMaterialEvaluation() const
   {
-    int whiteMaterial = 0;
-    int blackMaterial = 0;
-
-    for (PieceType pieceType = PAWN; pieceType <= QUEEN; pieceType++)
-    {
-      whiteMaterial += PIECE_VALUES[pieceType] * m_board.pieceCount(WHITE | pieceType);
-      blackMaterial += PIECE_VALUES[pieceType] * m_board.pieceCount(BLACK | pieceType);
-    }
+    int whiteMaterial = m_board.material(WHITE);
+    int blackMaterial = m_board.material(BLACK);
 
     whiteMaterial -= (whiteMaterial * whiteMaterial) >> MATERIAL_DIMINISH_SHIFT;
     blackMaterial -= (blackMaterial * blackMaterial) >> MATERIAL_DIMINISH_SHIFT;
@@ -46,21 +34,10 @@ namespace TungstenChess
     return whiteMaterial - blackMaterial;
   }
 
-  int Bot::getPiecePositionalEvaluation(Square pieceIndex, bool absolute) const
-  {
-    int positionalEvaluation = 0;
-
-    positionalEvaluation = PIECE_EVAL_TABLES[m_board[pieceIndex]][pieceIndex];
-
-    if (!absolute && (m_board[pieceIndex] & BLACK))
-      positionalEvaluation = -positionalEvaluation;
-
-    return positionalEvaluation;
-  }
-
-  int Bot::getPositionalEvaluation() const
+  Score Bot::getPositionalEvaluation() const
   {
-    int positionalEvaluation = 0;
+    // The piece-square tables of all pieces, kings included, are summed incrementally by the board
+    Score positionalEvaluation = m_board.positionalScore();
 
     Bitboard whitePieces = m_board.bitboard(WHITE_KNIGHT) |
                            m_board.bitboard(WHITE_BISHOP) |
@@ -72,59 +49,18 @@ namespace TungstenChess
                            m_board.bitboard(BLACK_ROOK) |
                            m_board.bitboard(BLACK_QUEEN);
 
-    Bitboard allPieces = m_board.bitboard(ALL_PIECES);
-
-    while (allPieces)
-    {
-      Square pieceIndex = Bitboards::popBit(allPieces);
-
-      if ((m_board[pieceIndex] & TYPE) == KING)
-        continue;
-
-      positionalEvaluation += getPiecePositionalEvaluation(pieceIndex);
-    }
-
-    {
-      Square whiteKingIndex = m_board.kingIndex(WHITE_KING);
-
-      Bitboard enemyPieces = blackPieces | m_board.bitboard(BLACK_PAWN);
-      Bitboard friendlyPieces = whitePieces;
-
-      float endgameScore = Bitboards::countBits(enemyPieces) / 16.0;
-
-      positionalEvaluation += KING_EVAL_TABLE[whiteKingIndex] * endgameScore;
-
-      positionalEvaluation += KING_ENDGAME_EVAL_TABLE[whiteKingIndex] * (1 - endgameScore);
+    Square whiteKingIndex = m_board.kingIndex(WHITE_KING);
+    Square blackKingIndex = m_board.kingIndex(BLACK_KING);
 
-      if (Bitboards::countBits(friendlyPieces) <= 3 && Bitboards::countBits(friendlyPieces) >= 1)
-      {
-        int kingsDistance = abs(whiteKingIndex % 8 - m_board.kingIndex(BLACK_KING) % 8) +
-                            abs(whiteKingIndex / 8 - m_board.kingIndex(BLACK_KING) / 8);
-
-        positionalEvaluation += KINGS_DISTANCE_EVAL_TABLE[kingsDistance];
-      }
-    }
-
-    {
-      Square blackKingIndex = m_board.kingIndex(BLACK_KING);
+    int kingsDistance = abs(whiteKingIndex % 8 - blackKingIndex % 8) + abs(whiteKingIndex / 8 - blackKingIndex / 8);
+    Score kingsDistanceScore = makeScore(KINGS_DISTANCE_EVAL_TABLE[kingsDistance], KINGS_DISTANCE_EVAL_TABLE[kingsDistance]);
 
-      Bitboard enemyPieces = whitePieces | m_board.bitboard(WHITE_PAWN);
-      Bitboard friendlyPieces = blackPieces;
+    // A side with little material left is rewarded for bringing its king closer to the enemy king
+    if (Bitboards::countBits(whitePieces) <= 3 && Bitboards::countBits(whitePieces) >= 1)
+      positionalEvaluation += kingsDistanceScore;
 
-      float endgameScore = Bitboards::countBits(enemyPieces) / 16.0;
-
-      positionalEvaluation -= KING_EVAL_TABLE[63 - blackKingIndex] * endgameScore;
-
-      positionalEvaluation -= KING_ENDGAME_EVAL_TABLE[63 - blackKingIndex] * (1 - endgameScore);
-
-      if (Bitboards::countBits(friendlyPieces) <= 3 && Bitboards::countBits(friendlyPieces) >= 1)
-      {
-        int kingsDistance = abs(blackKingIndex % 8 - m_board.kingIndex(WHITE_KING) % 8) +
-                            abs(blackKingIndex / 8 - m_board.kingIndex(WHITE_KING) / 8);
-
-        positionalEvaluation -= KINGS_DISTANCE_EVAL_TABLE[kingsDistance];
-      }
-    }
+    if (Bitboards::countBits(blackPieces) <= 3 && Bitboards::countBits(blackPieces) >= 1)
+      positionalEvaluation -= kingsDistanceScore;
 
     return positionalEvaluation;
   }
@@ -158,117 +94,129 @@ namespace TungstenChess
     return mobilityEvaluation;
   }
 
-  int Bot::getEvaluationBonus() const
+  const PawnHashTable::Entry& Bot::getPawnStructure()
   {
-    int evaluationBonus = 0;
-
-    evaluationBonus += BISHOP_PAIR_BONUS * ((m_board.pieceCount(WHITE_BISHOP) >= 2) - (m_board.pieceCount(BLACK_BISHOP) >= 2));
+    PawnHashTable::Entry& entry = m_pawnHashTable.slot(m_board.pawnKey());
 
-    evaluationBonus += CAN_CASTLE_BONUS * CASTLING_BONUS_MULTIPLIERS[m_board.castlingRights()];
+    if (entry.key == m_board.pawnKey())
+      return entry;
 
-    evaluationBonus += CASTLED_KING_BONUS * (bool(m_board.hasCastled() & WHITE) - bool(m_board.hasCastled() & BLACK));
+    entry.key = m_board.pawnKey();
+    entry.score = 0;
+    entry.pawnFiles = { 0, 0 };
 
     std::array<uint, 8> whitePawnsOnFiles = { 0 };
     std::array<uint, 8> blackPawnsOnFiles = { 0 };
 
-    std::array<bool, 8> whitePawnsOnNeighboringFiles = { false };
-    std::array<bool, 8> blackPawnsOnNeighboringFiles = { false };
-
     for (File file = 0; file < 8; file++)
     {
       whitePawnsOnFiles[file] = Bitboards::countBits(Bitboards::file(m_board.bitboard(WHITE_PAWN), file));
       blackPawnsOnFiles[file] = Bitboards::countBits(Bitboards::file(m_board.bitboard(BLACK_PAWN), file));
 
-      if (file > 0)
+      entry.pawnFiles[0] |= bool(whitePawnsOnFiles[file]) << file;
+      entry.pawnFiles[1] |= bool(blackPawnsOnFiles[file]) << file;
+    }
+
+    uint8_t whitePawnsOnNeighboringFiles = PawnHashTable::neighboringFiles(entry.pawnFiles[0]);
+    uint8_t blackPawnsOnNeighboringFiles = PawnHashTable::neighboringFiles(entry.pawnFiles[1]);
+
+    for (File file = 0; file < 8; file++)
+    {
+      entry.score -= DOUBLED_PAWN_PENALTY * ((whitePawnsOnFiles[file] > 1) - (blackPawnsOnFiles[file] > 1));
+
+      if (whitePawnsOnFiles[file])
       {
-        whitePawnsOnNeighboringFiles[file - 1] |= bool(whitePawnsOnFiles[file]);
-        blackPawnsOnNeighboringFiles[file - 1] |= bool(blackPawnsOnFiles[file]);
+        if (!(blackPawnsOnNeighboringFiles >> file & 1))
+          entry.score += PASSED_PAWN_BONUS;
+
+        if (!(whitePawnsOnNeighboringFiles >> file & 1))
+          entry.score -= ISOLATED_PAWN_PENALTY;
       }
-      if (file < 7)
+      if (blackPawnsOnFiles[file])
       {
-        whitePawnsOnNeighboringFiles[file + 1] |= bool(whitePawnsOnFiles[file]);
-        blackPawnsOnNeighboringFiles[file + 1] |= bool(blackPawnsOnFiles[file]);
+        if (!(whitePawnsOnNeighboringFiles >> file & 1))
+          entry.score -= PASSED_PAWN_BONUS;
+
+        if (!(blackPawnsOnNeighboringFiles >> file & 1))
+          entry.score += ISOLATED_PAWN_PENALTY;
       }
     }
 
-    for (Square i = 0; i < 64; i++)
-    {
-      File file = i % 8;
-      Rank rank = i / 8;
+    return entry;
+  }
 
-      if (rank == 0)
-      {
-        evaluationBonus -= DOUBLED_PAWN_PENALTY * ((whitePawnsOnFiles[file] > 1) - (blackPawnsOnFiles[file] > 1));
-
-        if (whitePawnsOnFiles[file])
-        {
-          if (!blackPawnsOnNeighboringFiles[file])
-            evaluationBonus += PASSED_PAWN_BONUS;
-
-          if (!whitePawnsOnNeighboringFiles[file])
-            evaluationBonus -= ISOLATED_PAWN_PENALTY;
-        }
-        if (blackPawnsOnFiles[file])
-        {
-          if (!whitePawnsOnNeighboringFiles[file])
-            evaluationBonus -= PASSED_PAWN_BONUS;
-
-          if (!blackPawnsOnNeighboringFiles[file])
-            evaluationBonus += ISOLATED_PAWN_PENALTY;
-        }
-      }
+  Score Bot::getEvaluationBonus()
+  {
+    Score evaluationBonus = 0;
 
-      if (!m_board[i])
-        continue;
+    evaluationBonus += BISHOP_PAIR_BONUS * ((m_board.pieceCount(WHITE_BISHOP) >= 2) - (m_board.pieceCount(BLACK_BISHOP) >= 2));
 
-      if (m_board[i] == WHITE_ROOK)
-      {
-        if (!(blackPawnsOnFiles[file] || whitePawnsOnFiles[file]))
-          evaluationBonus += ROOK_ON_OPEN_FILE_BONUS;
-        else if (!blackPawnsOnFiles[file])
-          evaluationBonus += ROOK_ON_SEMI_OPEN_FILE_BONUS;
+    evaluationBonus += CAN_CASTLE_BONUS * CASTLING_BONUS_MULTIPLIERS[m_board.castlingRights()];
 
-        continue;
-      }
-      if (m_board[i] == BLACK_ROOK)
-      {
-        if (!(blackPawnsOnFiles[file] || whitePawnsOnFiles[file]))
-          evaluationBonus -= ROOK_ON_OPEN_FILE_BONUS;
-        else if (!whitePawnsOnFiles[file])
-          evaluationBonus -= ROOK_ON_SEMI_OPEN_FILE_BONUS;
+    evaluationBonus += CASTLED_KING_BONUS * (bool(m_board.hasCastled() & WHITE) - bool(m_board.hasCastled() & BLACK));
 
-        continue;
-      }
+    const PawnHashTable::Entry& pawnStructure = getPawnStructure();
 
-      if (m_board[i] == WHITE_KNIGHT)
-      {
-        if (file > 0 && file < 7 && !blackPawnsOnNeighboringFiles[file])
-          evaluationBonus += KNIGHT_OUTPOST_BONUS;
-        continue;
-      }
-      if (m_board[i] == BLACK_KNIGHT)
-      {
-        if (file > 0 && file < 7 && !whitePawnsOnNeighboringFiles[file])
-          evaluationBonus -= KNIGHT_OUTPOST_BONUS;
-        continue;
-      }
+    evaluationBonus += pawnStructure.score;
 
-      if (rank == 0 && m_board[i] == WHITE_KING)
-      {
-        int pawnShieldWeight = (m_board[i - 8] == WHITE_PAWN) +
-                               Bitboards::countBits(MovesLookup::PAWN_CAPTURE_MOVES.at(WHITE_PAWN, i) & m_board.bitboard(WHITE_PAWN));
+    uint8_t whitePawnFiles = pawnStructure.pawnFiles[0];
+    uint8_t blackPawnFiles = pawnStructure.pawnFiles[1];
+    uint8_t whitePawnsOnNeighboringFiles = PawnHashTable::neighboringFiles(whitePawnFiles);
+    uint8_t blackPawnsOnNeighboringFiles = PawnHashTable::neighboringFiles(blackPawnFiles);
 
-        evaluationBonus += KING_SAFETY_PAWN_SHIELD_PER_PAWN_BONUS * pawnShieldWeight;
-        continue;
-      }
-      if (rank == 7 && m_board[i] == BLACK_KING)
-      {
-        int pawnShieldWeight = (m_board[i + 8] == BLACK_PAWN) +
-                               Bitboards::countBits(MovesLookup::PAWN_CAPTURE_MOVES.at(BLACK_PAWN, i) & m_board.bitboard(BLACK_PAWN));
+    Bitboard whiteRooks = m_board.bitboard(WHITE_ROOK);
+    while (whiteRooks)
+    {
+      File file = Bitboards::popBit(whiteRooks) % 8;
 
-        evaluationBonus -= KING_SAFETY_PAWN_SHIELD_PER_PAWN_BONUS * pawnShieldWeight;
-        continue;
-      }
+      if (!((whitePawnFiles | blackPawnFiles) >> file & 1))
+        evaluationBonus += ROOK_ON_OPEN_FILE_BONUS;
+      else if (!(blackPawnFiles >> file & 1))
+        evaluationBonus += ROOK_ON_SEMI_OPEN_FILE_BONUS;
+    }
+    Bitboard blackRooks = m_board.bitboard(BLACK_ROOK);
+    while (blackRooks)
+    {
+      File file = Bitboards::popBit(blackRooks) % 8;
+
+      if (!((whitePawnFiles | blackPawnFiles) >> file & 1))
+        evaluationBonus -= ROOK_ON_OPEN_FILE_BONUS;
+      else if (!(whitePawnFiles >> file & 1))
+        evaluationBonus -= ROOK_ON_SEMI_OPEN_FILE_BONUS;
+    }
+
+    Bitboard whiteKnights = m_board.bitboard(WHITE_KNIGHT);
+    while (whiteKnights)
+    {
+      File file = Bitboards::popBit(whiteKnights) % 8;
+
+      if (file > 0 && file < 7 && !(blackPawnsOnNeighboringFiles >> file & 1))
+        evaluationBonus += KNIGHT_OUTPOST_BONUS;
+    }
+    Bitboard blackKnights = m_board.bitboard(BLACK_KNIGHT);
+    while (blackKnights)
+    {
+      File file = Bitboards::popBit(blackKnights) % 8;
+
+      if (file > 0 && file < 7 && !(whitePawnsOnNeighboringFiles >> file & 1))
+        evaluationBonus -= KNIGHT_OUTPOST_BONUS;
+    }
+
+    Square whiteKing = m_board.kingIndex(WHITE_KING);
+    if (whiteKing / 8 == 7)
+    {
+      int pawnShieldWeight = (m_board[whiteKing - 8] == WHITE_PAWN) +
+                             Bitboards::countBits(MovesLookup::PAWN_CAPTURE_MOVES[WHITE_PAWN][whiteKing] & m_board.bitboard(WHITE_PAWN));
+
+      evaluationBonus += KING_SAFETY_PAWN_SHIELD_PER_PAWN_BONUS * pawnShieldWeight;
+    }
+    Square blackKing = m_board.kingIndex(BLACK_KING);
+    if (blackKing / 8 == 0)
+    {
+      int pawnShieldWeight = (m_board[blackKing + 8] == BLACK_PAWN) +
+                             Bitboards::countBits(MovesLookup::PAWN_CAPTURE_MOVES[BLACK_PAWN][blackKing] & m_board.bitboard(BLACK_PAWN));
+
+      evaluationBonus -= KING_SAFETY_PAWN_SHIELD_PER_PAWN_BONUS * pawnShieldWeight;
     }
 
     return evaluationBonus;
@@ -1,7 +1,9 @@
 #include "bot/engine.hpp"
 
 #include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include "bot/piece_eval_tables.hpp"
 
@@ -13,11 +15,20 @@ namespace TungstenChess
         [this]()
         {
           std::unique_lock<std::mutex> lock(m_searchTimerMutex);
-          m_searchTimerEvent.wait(lock);
+          m_searchTimerEvent.wait(lock, [this]
+                                  { return m_searchTimerReset.load(); });
           while (!m_searchTimerTerminated)
           {
             m_searchTimerReset = false;
 
+            // A negative time leaves the timer disarmed until the next search
+            if (m_maxSearchTime < 0)
+            {
+              m_searchTimerEvent.wait(lock, [this]
+                                      { return m_searchTimerReset.load(); });
+              continue;
+            }
+
             if (m_searchTimerEvent.wait_for(lock, std::chrono::milliseconds(m_maxSearchTime), [this]
                                             { return m_searchTimerReset.load(); }))
               continue;
@@ -26,25 +37,215 @@ namespace TungstenChess
           }
         }
     );
-
-    m_searchTimerThread.detach();
   }
 
   void Bot::stopSearchTimerThread()
   {
     m_searchCancelled = true;
     m_searchTimerTerminated = true;
-    m_searchTimerReset = true;
+
+    {
+      std::lock_guard<std::mutex> lock(m_searchTimerMutex);
+      m_searchTimerReset = true;
+    }
+    m_searchTimerEvent.notify_one();
+
     if (m_searchTimerThread.joinable())
       m_searchTimerThread.join();
   }
 
+  void Bot::createHelpers()
+  {
+    // Bots before boards, since each helper bot refers to its board
+    m_helperBots.clear();
+    m_helperBoards.clear();
+
+    for (int i = 1; i < m_botSettings.searchThreads; i++)
+    {
+      m_helperBoards.push_back(std::make_unique<Board>(m_board.createBranch()));
+      m_helperBots.push_back(std::unique_ptr<Bot>(new Bot(*m_helperBoards.back(), *this)));
+    }
+  }
+
+  void Bot::startHelperThreads()
+  {
+    for (size_t i = 0; i < m_helperBots.size(); i++)
+    {
+      m_helperBoards[i]->rebranch(m_board);
+
+      Bot* helper = m_helperBots[i].get();
+      helper->m_previousSearchInfo.reset();
+      helper->m_nodesSearched = 0;
+      helper->m_searchCancelled = false;
+      helper->m_searchPly = 0;
+      helper->m_extensionsOnPath = 0;
+      helper->m_moveHistory.newSearch();
+
+      // Stagger the starting depths so that helpers tend to work on different iterations than the main thread
+      int startDepth = 1 + (i + 1) % 2;
+
+      m_helperThreads.emplace_back([helper, startDepth]()
+                                   { helper->m_previousSearchInfo.bestMove = helper->runIterativeDeepening(startDepth); });
+    }
+  }
+
+  void Bot::stopHelperThreads()
+  {
+    for (std::unique_ptr<Bot>& helper : m_helperBots)
+      helper->m_searchCancelled = true;
+
+    for (std::thread& thread : m_helperThreads)
+      thread.join();
+
+    for (std::unique_ptr<Bot>& helper : m_helperBots)
+    {
+      const SearchInfo& helperSearchInfo = helper->m_previousSearchInfo;
+
+      m_previousSearchInfo.positionsEvaluated += helperSearchInfo.positionsEvaluated;
+      m_previousSearchInfo.transpositionsUsed += helperSearchInfo.transpositionsUsed;
+
+      if (helperSearchInfo.bestMove == NULL_MOVE || m_previousSearchInfo.mateFound)
+        continue;
+
+      if (helperSearchInfo.mateFound || helperSearchInfo.depthSearched > m_previousSearchInfo.depthSearched)
+      {
+        m_previousSearchInfo.depthSearched = helperSearchInfo.depthSearched;
+        m_previousSearchInfo.nextDepthNumMovesSearched = helperSearchInfo.nextDepthNumMovesSearched;
+        m_previousSearchInfo.nextDepthTotalMoves = helperSearchInfo.nextDepthTotalMoves;
+        m_previousSearchInfo.evaluation = helperSearchInfo.evaluation;
+        m_previousSearchInfo.mateFound = helperSearchInfo.mateFound;
+        m_previousSearchInfo.mateIn = helperSearchInfo.mateIn;
+        m_previousSearchInfo.lossFound = helperSearchInfo.lossFound;
+        m_previousSearchInfo.bestMove = helperSearchInfo.bestMove;
+      }
+    }
+
+    m_helperThreads.clear();
+  }
+
+  uint64_t Bot::getNodesSearched() const
+  {
+    uint64_t nodesSearched = m_nodesSearched.load(std::memory_order_relaxed);
+
+    for (const std::unique_ptr<Bot>& helper : m_helperBots)
+      nodesSearched += helper->m_nodesSearched.load(std::memory_order_relaxed);
+
+    return nodesSearched;
+  }
+
+  void Bot::setBotSettings(const BotSettings& settings)
+  {
+    bool resizeTranspositionTable = settings.transpositionTableSizeMB != m_botSettings.transpositionTableSizeMB;
+    bool resizeHelpers = settings.searchThreads != m_botSettings.searchThreads;
+
+    m_botSettings = settings;
+
+    if (resizeTranspositionTable)
+      m_transpositionTable = std::make_shared<TranspositionTable>(m_botSettings.transpositionTableSizeMB);
+
+    if (resizeHelpers)
+      createHelpers();
+
+    // Helpers that are kept follow the new settings and table, only the main bot reports on the search
+    for (std::unique_ptr<Bot>& helper : m_helperBots)
+    {
+      helper->m_botSettings = m_botSettings;
+      helper->m_botSettings.logUCIInfo = false;
+      helper->m_transpositionTable = m_transpositionTable;
+    }
+  }
+
   void Bot::addMove(Move move)
   {
     m_openingBook.addMove(move);
   }
 
+  int Bot::getAllottedSearchTime(const SearchLimits& searchLimits) const
+  {
+    int time = searchLimits.maxSearchTime;
+
+    if (searchLimits.timeLeft >= 0)
+    {
+      int movesToGo = searchLimits.movesToGo > 0 ? searchLimits.movesToGo : DEFAULT_MOVES_TO_GO;
+
+      int allottedTime = searchLimits.timeLeft / movesToGo + searchLimits.increment * 3 / 4;
+      allottedTime = std::min(allottedTime, searchLimits.timeLeft - m_botSettings.moveOverhead);
+      allottedTime = std::max(allottedTime, 1);
+
+      time = time < 0 ? allottedTime : std::min(time, allottedTime);
+    }
+
+    return time;
+  }
+
+  std::vector<Move> Bot::getPrincipalVariation(Move bestMove, int maxLength)
+  {
+    std::vector<Move> principalVariation;
+    std::vector<Board::UnmoveData> unmoveData;
+
+    Move move = bestMove;
+
+    while (move != NULL_MOVE && int(principalVariation.size()) < maxLength && m_board.isLegalMove(move))
+    {
+      principalVariation.push_back(move);
+      unmoveData.push_back(m_board.makeMove(move));
+
+      // The table may contain a cycle of best moves, so stop at the first repetition
+      if (m_board.isRepetition(principalVariation.size()))
+        break;
+
+      TranspositionTable::Entry entry;
+      move = m_transpositionTable->probe(m_board.zobristKey(), entry) ? entry.move() : NULL_MOVE;
+    }
+
+    for (size_t i = principalVariation.size(); i-- > 0;)
+      m_board.unmakeMove(principalVariation[i], unmoveData[i]);
+
+    return principalVariation;
+  }
+
+  void Bot::logUCIInfo(Move bestMove)
+  {
+    int64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::high_resolution_clock::now() - m_searchStartTime
+    )
+                       .count();
+
+    uint64_t nodesSearched = getNodesSearched();
+
+    std::ostringstream info;
+
+    info << "info depth " << m_previousSearchInfo.depthSearched
+         << " seldepth " << std::max(m_previousSearchInfo.selectiveDepth, m_previousSearchInfo.depthSearched);
+
+    if (m_previousSearchInfo.mateFound)
+      info << " score mate " << m_previousSearchInfo.mateIn + 1;
+    else if (m_previousSearchInfo.lossFound)
+      info << " score mate " << -(m_previousSearchInfo.mateIn + 1);
+    else
+      info << " score cp " << m_previousSearchInfo.evaluation;
+
+    info << " nodes " << nodesSearched
+         << " nps " << nodesSearched * 1000 / std::max<int64_t>(time, 1)
+         << " hashfull " << m_transpositionTable->hashfull()
+         << " time " << time
+         << " pv";
+
+    for (Move move : getPrincipalVariation(bestMove, std::max(m_previousSearchInfo.depthSearched, 1)))
+      info << " " << Moves::getUCI(move);
+
+    std::cout << info.str() << std::endl;
+  }
+
   Move Bot::generateBotMove(int maxSearchTime)
+  {
+    SearchLimits searchLimits;
+    searchLimits.maxSearchTime = maxSearchTime == -1 ? m_botSettings.maxSearchTime : maxSearchTime;
+
+    return generateBotMove(searchLimits);
+  }
+
+  Move Bot::generateBotMove(const SearchLimits& searchLimits)
   {
     if (m_botSettings.useOpeningBook &&
         m_onceOpeningBookLoaded.peek() &&
@@ -67,7 +268,9 @@ namespace TungstenChess
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    Move bestMove = iterativeDeepeningSearch(maxSearchTime == -1 ? m_botSettings.maxSearchTime : maxSearchTime);
+    m_searchLimits = searchLimits;
+
+    Move bestMove = iterativeDeepeningSearch(getAllottedSearchTime(searchLimits));
 
     if (m_botSettings.logSearchInfo)
     {
@@ -110,7 +313,7 @@ namespace TungstenChess
 
           << "   Occupied: "
           << std::right << std::setw(16)
-          << m_transpositionTable.occupancy()
+          << m_transpositionTable->occupancy()
 
           << "   Evaluation: "
           << evalString
@@ -120,31 +323,74 @@ namespace TungstenChess
     return bestMove;
   }
 
-  int Bot::negamax(int depth, int alpha, int beta, bool quiesce)
+  int Bot::negamax(int depth, int alpha, int beta, bool quiesce, bool allowNullMove)
   {
-    if (m_searchCancelled)
+    if (isSearchStopped())
       return 0;
 
-    bool found;
-    const TranspositionTable::Entry& entry = m_transpositionTable.retrieve(m_board.zobristKey(), found);
+    uint64_t nodesSearched = m_nodesSearched.load(std::memory_order_relaxed) + 1;
+    m_nodesSearched.store(nodesSearched, std::memory_order_relaxed);
+
+    if (m_searchLimits.maxNodes && (nodesSearched & NODE_LIMIT_CHECK_MASK) == 0 && getNodesSearched() >= m_searchLimits.maxNodes)
+      m_searchCancelled = true;
 
-    if (found && entry.quiesce() == quiesce && entry.depth() >= depth)
+    if (m_searchPly > m_previousSearchInfo.selectiveDepth)
+      m_previousSearchInfo.selectiveDepth = m_searchPly;
+
+    // Mate distance pruning - no line from here can end in a faster mate than one already found closer to the root
+    if (!quiesce && m_searchPly > 0)
     {
-      bool isTerminal = abs(entry.evaluation()) == INF_EVAL;
+      alpha = std::max(alpha, -INF_EVAL + m_searchPly);
+      beta = std::min(beta, INF_EVAL - m_searchPly - 1);
+
+      if (alpha >= beta)
+        return alpha;
+    }
 
-      // Ignore transposition table entry if it is a terminal position evaluated in a previous search
-      // to avoid premature mate detection
-      if (!(isTerminal && entry.searchId() < m_currentSearchId && entry.depth() > depth))
+    // A singular extension search of this node excluding a move, whose result must not be mixed with the node's own
+    Move excludedMove = m_searchPly < MoveHistory::MAX_PLY ? m_searchStack[m_searchPly].excludedMove : NULL_MOVE;
+
+    TranspositionTable::Entry entry;
+    bool found = m_transpositionTable->probe(m_board.zobristKey(), entry);
+
+    int entryEvaluation = found ? evaluationFromTranspositionTable(entry.evaluation()) : 0;
+
+    if (found && excludedMove == NULL_MOVE && entry.quiesce() == quiesce && entry.depth() >= depth)
+    {
+      TranspositionTable::Bound bound = entry.bound();
+
+      if (bound == TranspositionTable::EXACT_BOUND ||
+          (bound == TranspositionTable::LOWER_BOUND && entryEvaluation >= beta) ||
+          (bound == TranspositionTable::UPPER_BOUND && entryEvaluation <= alpha))
       {
         m_previousSearchInfo.transpositionsUsed++;
-        return entry.evaluation();
+        return entryEvaluation;
       }
     }
 
+    if (!quiesce && depth == 0)
+      return negamax(m_botSettings.quiesceDepth, alpha, beta, true);
+
+    if (m_board.isRepetition(m_searchPly) || m_board.halfmoveClock() >= 100)
+      return -CONTEMPT;
+
+    // If the side to move can return to an earlier position of the search, it can hold at least a draw
+    if (alpha < -CONTEMPT && m_board.hasUpcomingRepetition(m_searchPly))
+    {
+      alpha = -CONTEMPT;
+
+      if (alpha >= beta)
+        return beta;
+    }
+
     int standPat;
 
     if (quiesce)
     {
+      // Only captures are searched here, so a mate would go unnoticed and be stood pat. Stalemates are rare enough to be ignored
+      if (m_board.isInCheck(m_board.sideToMove()) && !m_board.hasAnyLegalMove(m_board.sideToMove()))
+        return -INF_EVAL + m_searchPly;
+
       standPat = getStaticEvaluation();
 
       if (depth == 0)
@@ -156,194 +402,436 @@ namespace TungstenChess
       if (alpha >= beta)
         return beta;
     }
-    else
+
+    bool inCheck = !quiesce && m_board.isInCheck(m_board.sideToMove());
+    bool isPVNode = beta - alpha > 1;
+
+    // The static evaluation drives the forward pruning below. It is meaningless in check, where every evasion must be searched
+    int staticEvaluation = NO_EVALUATION;
+    if (!quiesce && !inCheck)
+      staticEvaluation = getStaticEvaluation();
+
+    if (!quiesce && m_searchPly < MoveHistory::MAX_PLY)
+      m_searchStack[m_searchPly].staticEvaluation = staticEvaluation;
+
+    // Whether the position is better for the side to move than two plies ago, in which case pruning is less aggressive
+    bool improving = m_searchPly < 2 || m_searchPly - 2 >= MoveHistory::MAX_PLY ||
+                     staticEvaluation > m_searchStack[m_searchPly - 2].staticEvaluation;
+
+    if (!quiesce && !inCheck && !isPVNode && excludedMove == NULL_MOVE && abs(beta) < MATE_THRESHOLD)
     {
-      if (depth == 0)
-        return negamax(m_botSettings.quiesceDepth, alpha, beta, true);
+      // Reverse futility pruning - far enough above beta that no move is expected to lose the advantage
+      if (depth <= REVERSE_FUTILITY_MAX_DEPTH && staticEvaluation - m_botSettings.reverseFutilityMargin * (depth - improving) >= beta)
+        return staticEvaluation;
+
+      // Razoring - far enough below alpha that only a tactic could help, so quiescence search decides
+      if (depth <= RAZORING_MAX_DEPTH && staticEvaluation + m_botSettings.razoringMargin * depth < alpha)
+      {
+        int razoringEvaluation = negamax(m_botSettings.quiesceDepth, alpha - 1, alpha, true);
+
+        if (isSearchStopped())
+          return 0;
+
+        if (razoringEvaluation < alpha)
+          return razoringEvaluation;
+      }
     }
 
-    if (m_board.hasRepeatedThrice(m_board.zobristKey()) || m_board.halfmoveClock() >= 100)
-      return -CONTEMPT;
+    // Null move pruning - if passing the turn still fails high, a real move would almost certainly fail high too.
+    // Skipped when in check (passing would be illegal), in mate windows, and with too little material to rule out zugzwang
+    if (!quiesce && allowNullMove && !inCheck && excludedMove == NULL_MOVE && depth >= NULL_MOVE_MIN_DEPTH && beta < MATE_THRESHOLD &&
+        m_board.hasNullMoveMaterial(m_board.sideToMove()) && staticEvaluation >= beta)
+    {
+      int reduction = NULL_MOVE_REDUCTION + depth / NULL_MOVE_REDUCTION_DEPTH_DIVISOR;
+      int nullMoveDepth = std::max(depth - 1 - reduction, 0);
 
-    MoveAllocation legalMoves(m_moveStack);
-    int legalMovesCount = getSortedLegalMoves(legalMoves, quiesce);
+      Board::UnmoveData unmoveData = m_board.makeNullMove();
+      recordSearchMove(NULL_MOVE, false);
+      m_searchPly++;
 
-    if (legalMovesCount == 0)
+      int nullMoveEvaluation = -negamax(nullMoveDepth, -beta, -beta + 1, false, false);
+
+      m_searchPly--;
+      m_board.unmakeNullMove(unmoveData);
+
+      if (isSearchStopped())
+        return 0;
+
+      if (nullMoveEvaluation >= beta)
+      {
+        // A mate found after passing is not a proven mate
+        if (nullMoveEvaluation >= MATE_THRESHOLD)
+          nullMoveEvaluation = beta;
+
+        if (depth < NULL_MOVE_VERIFICATION_MIN_DEPTH)
+          return nullMoveEvaluation;
+
+        // At high depths the cutoff is verified with a reduced search of the node itself, without null moves
+        int verificationEvaluation = negamax(std::max(depth - reduction, 1), beta - 1, beta, false, false);
+
+        if (isSearchStopped())
+          return 0;
+
+        if (verificationEvaluation >= beta)
+          return nullMoveEvaluation;
+      }
+    }
+
+    Move hashMove = found ? entry.move() : NULL_MOVE;
+
+    // Internal iterative reduction - without a hash move this node was never searched (or always failed low),
+    // so a cheaper search first is expected to either refute it or leave a hash move for the next iteration
+    if (!quiesce && hashMove == NULL_MOVE && excludedMove == NULL_MOVE && depth >= IIR_MIN_DEPTH)
+      depth--;
+
+    // Singular extension - if every other move fails low against a margin below the hash move's evaluation, the hash
+    // move is the only good move here and is extended. If even the other moves beat beta, the node fails high without it
+    bool isHashMoveSingular = false;
+    if (!quiesce && excludedMove == NULL_MOVE && hashMove != NULL_MOVE && m_searchPly > 0 && m_searchPly < MoveHistory::MAX_PLY &&
+        depth >= SINGULAR_EXTENSION_MIN_DEPTH && !entry.quiesce() && entry.bound() != TranspositionTable::UPPER_BOUND &&
+        entry.depth() >= depth - SINGULAR_EXTENSION_DEPTH_MARGIN && abs(entryEvaluation) < MATE_THRESHOLD)
     {
-      if (quiesce)
-        return standPat;
+      int singularBeta = entryEvaluation - SINGULAR_EXTENSION_MARGIN * depth;
 
-      bool isStalemate = !m_board.isInCheck(m_board.sideToMove());
-      if (isStalemate)
-        return -CONTEMPT;
-      else
-        return -INF_EVAL;
+      m_searchStack[m_searchPly].excludedMove = hashMove;
+      int singularEvaluation = negamax((depth - 1) / 2, singularBeta - 1, singularBeta, false, false);
+      m_searchStack[m_searchPly].excludedMove = NULL_MOVE;
+
+      if (isSearchStopped())
+        return 0;
+
+      if (singularEvaluation < singularBeta)
+        isHashMoveSingular = true;
+      else if (singularBeta >= beta)
+        return singularBeta;
     }
 
-    if (legalMovesCount == 1)
-      depth++;
+    MovePicker movePicker(m_board, m_moveStack, hashMove, quiesce, &m_moveHistory, m_searchPly, getPreviousSearchMove());
+
+    // Evasions are few, so they are all generated up front to extend positions with a single legal reply
+    bool isSingleReply = inCheck && movePicker.generateAllMoves() == 1;
+
+    int originalAlpha = alpha;
+    Move bestMove = NULL_MOVE;
+    int numMovesSearched = 0;
+
+    // Futility pruning - quiet moves cannot raise a position this far below alpha this close to the horizon
+    bool futilityPruning = !quiesce && !inCheck && !isPVNode && depth <= FUTILITY_MAX_DEPTH && abs(alpha) < MATE_THRESHOLD &&
+                           staticEvaluation + m_botSettings.futilityMargin * depth <= alpha;
+
+    // Quiet moves that did not cause a cutoff, penalized in the history table if a later quiet move does
+    std::array<Move, MAX_FAILED_QUIETS> failedQuiets;
+    int failedQuietsCount = 0;
 
-    for (Move& move : legalMoves)
+    Move move;
+    while ((move = movePicker.next()) != NULL_MOVE)
     {
+      if (move == excludedMove)
+        continue;
+
+      Square from = move & FROM;
+      Square to = (move & TO) >> 6;
+      bool isCapture = m_board[to] || ((m_board[from] & TYPE) == PAWN && (to - from) % 8);
+      bool isQuiet = !isCapture && !(move & PROMOTION_PIECE);
+
       Board::UnmoveData unmoveData = m_board.makeMove(move);
-      int evaluation = -negamax(depth - 1, -beta, -alpha, quiesce);
+
+      bool givesCheck = !quiesce && m_board.isInCheck(m_board.sideToMove());
+
+      if (futilityPruning && numMovesSearched > 0 && isQuiet && !givesCheck)
+      {
+        m_board.unmakeMove(move, unmoveData);
+        continue;
+      }
+
+      // Extensions - at most one ply per move, and only while the line is within its extension budget
+      int extension = 0;
+      if (!quiesce && m_extensionsOnPath < MAX_PATH_EXTENSIONS)
+      {
+        Move previousMove = getPreviousSearchMove();
+        bool isRecapture = isCapture && previousMove != NULL_MOVE && m_searchStack[m_searchPly - 1].capture &&
+                           ((previousMove & TO) >> 6) == to;
+
+        if ((move == hashMove && isHashMoveSingular) || givesCheck || isSingleReply || isRecapture)
+          extension = 1;
+      }
+
+      int newDepth = depth - 1 + extension;
+
+      recordSearchMove(move, isCapture);
+      m_searchPly++;
+      m_extensionsOnPath += extension;
+
+      // Late move reductions - quiet moves sorted late are unlikely to be best, so they are searched
+      // to a reduced depth first and only searched fully if they beat alpha
+      int reduction = 0;
+      if (!quiesce && !inCheck && isQuiet && !givesCheck && extension == 0 && depth >= LMR_MIN_DEPTH && numMovesSearched >= LMR_FULL_DEPTH_MOVES)
+      {
+        reduction = s_lateMoveReductions[std::min(depth, MAX_SEARCH_DEPTH)][numMovesSearched];
+
+        if (isPVNode)
+          reduction--;
+
+        reduction -= m_moveHistory.historyScore(m_board.sideToMove() ^ COLOR, move) / LMR_HISTORY_DIVISOR;
+
+        reduction = std::clamp(reduction, 0, depth - 2);
+      }
+
+      // Principal variation search - only the first move is searched with the full window, the rest are
+      // expected to fail low against a null window and are re-searched only if they do not
+      int evaluation;
+      if (numMovesSearched++ == 0)
+        evaluation = -negamax(newDepth, -beta, -alpha, quiesce);
+      else
+      {
+        evaluation = -negamax(newDepth - reduction, -alpha - 1, -alpha, quiesce);
+
+        if (reduction > 0 && evaluation > alpha)
+          evaluation = -negamax(newDepth, -alpha - 1, -alpha, quiesce);
+
+        if (evaluation > alpha && evaluation < beta)
+          evaluation = -negamax(newDepth, -beta, -alpha, quiesce);
+      }
+
+      m_extensionsOnPath -= extension;
+      m_searchPly--;
       m_board.unmakeMove(move, unmoveData);
 
-      if (m_searchCancelled)
+      if (isSearchStopped())
         return 0;
 
       if (evaluation > alpha)
       {
         alpha = evaluation;
+        bestMove = move;
 
         if (alpha >= beta)
-          return beta;
+        {
+          if (isQuiet && !quiesce)
+            m_moveHistory.updateQuietCutoff(m_board.sideToMove(), m_searchPly, depth, getPreviousSearchMove(), move, failedQuiets.data(), failedQuietsCount);
 
-        if (!quiesce && alpha >= INF_EVAL)
-          break;
+          if (excludedMove == NULL_MOVE)
+            m_transpositionTable->store(m_board.zobristKey(), move, evaluationToTranspositionTable(beta), depth, TranspositionTable::LOWER_BOUND, quiesce);
+
+          return beta;
+        }
       }
+
+      if (isQuiet && failedQuietsCount < MAX_FAILED_QUIETS)
+        failedQuiets[failedQuietsCount++] = move;
     }
 
-    if (!m_searchCancelled)
+    if (numMovesSearched == 0)
     {
-      m_transpositionTable.store(m_board.zobristKey(), m_currentSearchId, alpha, depth, quiesce);
+      if (quiesce)
+        return standPat;
+
+      // The excluded move was the only legal move, so it is singular
+      if (excludedMove != NULL_MOVE)
+        return alpha;
+
+      bool isStalemate = !inCheck;
+      if (isStalemate)
+        return -CONTEMPT;
+      else
+        return -INF_EVAL + m_searchPly;
+    }
+
+    if (excludedMove == NULL_MOVE)
+    {
+      TranspositionTable::Bound bound = alpha > originalAlpha ? TranspositionTable::EXACT_BOUND : TranspositionTable::UPPER_BOUND;
+      m_transpositionTable->store(m_board.zobristKey(), bestMove, evaluationToTranspositionTable(alpha), depth, bound, quiesce);
     }
 
     return alpha;
   }
 
-  Move Bot::generateBestMove(int depth, Move bestMoveSoFar)
+  Move Bot::generateBestMove(int depth, Move bestMoveSoFar, int alpha, int beta, int& evaluation)
   {
-    MoveAllocation legalMoves(m_moveStack);
-    int legalMovesCount = getSortedLegalMoves(legalMoves, false, bestMoveSoFar);
+    MovePicker movePicker(m_board, m_moveStack, bestMoveSoFar, false, &m_moveHistory);
+    int legalMovesCount = movePicker.generateAllMoves();
+
+    evaluation = alpha;
 
     if (legalMovesCount == 0)
       return NULL_MOVE;
 
-    Move bestMove = legalMoves[0];
+    Move bestMove = NULL_MOVE;
 
-    int alpha = -INF_EVAL;
+    int originalAlpha = alpha;
     int numMovesSearched = 0;
 
     m_previousSearchInfo.nextDepthNumMovesSearched = 0;
     m_previousSearchInfo.nextDepthTotalMoves = legalMovesCount;
 
-    for (Move& move : legalMoves)
+    Move move;
+    while ((move = movePicker.next()) != NULL_MOVE)
     {
+      if (bestMove == NULL_MOVE)
+        bestMove = move;
+
       Board::UnmoveData unmoveData = m_board.makeMove(move);
-      int evaluation = -negamax(depth - 1, -INF_EVAL, -alpha, false);
+      recordSearchMove(move, unmoveData.capturedPiece != NO_PIECE);
+      m_searchPly++;
+
+      int moveEvaluation;
+      if (numMovesSearched == 0)
+        moveEvaluation = -negamax(depth - 1, -beta, -alpha, false);
+      else
+      {
+        moveEvaluation = -negamax(depth - 1, -alpha - 1, -alpha, false);
+
+        if (moveEvaluation > alpha && moveEvaluation < beta)
+          moveEvaluation = -negamax(depth - 1, -beta, -alpha, false);
+      }
+
+      m_searchPly--;
       m_board.unmakeMove(move, unmoveData);
 
-      if (m_searchCancelled)
+      if (isSearchStopped())
       {
         if (numMovesSearched > 0)
           break;
-        else
-          return NULL_MOVE;
+
+        // Stopped before any move was searched (e.g. right after "go"), which must still answer with a legal move
+        return bestMoveSoFar != NULL_MOVE ? bestMoveSoFar : move;
       }
 
       numMovesSearched++;
 
-      if (evaluation > alpha)
+      if (moveEvaluation > alpha)
       {
-        alpha = evaluation;
+        alpha = moveEvaluation;
         bestMove = move;
 
-        if (alpha >= INF_EVAL)
-        {
-          m_previousSearchInfo.mateFound = true;
+        if (alpha >= beta)
           break;
-        }
       }
     }
 
-    if (!m_searchCancelled && !m_previousSearchInfo.mateFound)
+    evaluation = alpha;
+
+    // Only results inside the window are exact, a failed aspiration window is re-searched by aspirationSearch
+    if (!isSearchStopped() && alpha > originalAlpha && alpha < beta)
     {
       m_previousSearchInfo.evaluation = alpha;
       m_previousSearchInfo.depthSearched = depth;
+      m_previousSearchInfo.mateFound = alpha >= MATE_THRESHOLD;
+      m_previousSearchInfo.lossFound = alpha <= -MATE_THRESHOLD;
     }
 
     m_previousSearchInfo.nextDepthNumMovesSearched = numMovesSearched;
 
+    // Storing the root result lets the next iteration, helper threads and the next search start from the best move
+    if (!isSearchStopped())
+    {
+      TranspositionTable::Bound bound = alpha >= beta           ? TranspositionTable::LOWER_BOUND
+                                        : alpha > originalAlpha ? TranspositionTable::EXACT_BOUND
+                                                                : TranspositionTable::UPPER_BOUND;
+      m_transpositionTable->store(m_board.zobristKey(), bound == TranspositionTable::UPPER_BOUND ? NULL_MOVE : bestMove,
+                                  alpha, depth, bound, false);
+    }
+
     return bestMove;
   }
 
-  Move Bot::iterativeDeepeningSearch(int time)
+  Move Bot::aspirationSearch(int depth, Move bestMoveSoFar)
   {
-    m_searchCancelled = false;
+    int evaluation;
 
-    int depth = 1;
+    int previousEvaluation = m_previousSearchInfo.evaluation;
 
-    m_maxSearchTime = time;
-    m_searchTimerReset = true;
-    m_searchTimerEvent.notify_one();
+    if (depth < ASPIRATION_MIN_DEPTH || abs(previousEvaluation) >= MATE_THRESHOLD)
+      return generateBestMove(depth, bestMoveSoFar, -INF_EVAL, INF_EVAL, evaluation);
 
-    m_currentSearchId++;
+    int window = m_botSettings.aspirationWindow;
+    int alpha = std::max(previousEvaluation - window, -INF_EVAL);
+    int beta = std::min(previousEvaluation + window, INF_EVAL);
 
-    Move bestMove = generateBestMove(depth);
-
-    while (!m_searchCancelled)
+    while (true)
     {
-      depth++;
-
-      Move newMove = generateBestMove(depth, bestMove);
+      Move bestMove = generateBestMove(depth, bestMoveSoFar, alpha, beta, evaluation);
 
-      if (newMove == NULL_MOVE)
-        break;
-
-      bestMove = newMove;
+      if (bestMove == NULL_MOVE || isSearchStopped())
+        return bestMove;
 
-      if (m_previousSearchInfo.mateFound)
-      {
-        m_previousSearchInfo.mateIn = (depth - 1) / 2;
-        break;
-      }
+      window *= 2;
 
-      if (m_previousSearchInfo.evaluation <= -INF_EVAL)
+      if (evaluation <= alpha)
+        alpha = std::max(alpha - window, -INF_EVAL);
+      else if (evaluation >= beta)
       {
-        m_previousSearchInfo.lossFound = true;
-        m_previousSearchInfo.mateIn = (depth - 1) / 2;
-        break;
+        beta = std::min(beta + window, INF_EVAL);
+        bestMoveSoFar = bestMove;
       }
+      else
+        return bestMove;
     }
-
-    return bestMove;
   }
 
-  void Bot::heuristicSortMoves(MoveAllocation& moves, int numMovesToSort, Move bestMove)
+  Move Bot::iterativeDeepeningSearch(int time)
   {
-    std::partial_sort(
-        moves.begin(),
-        moves.begin() + numMovesToSort,
-        moves.end(),
-        [this, bestMove](Move a, Move b)
-        { return heuristicEvaluation(a, bestMove) > heuristicEvaluation(b, bestMove); }
-    );
-  }
+    m_searchStartTime = std::chrono::high_resolution_clock::now();
+    m_nodesSearched = 0;
+    m_searchPly = 0;
+    m_extensionsOnPath = 0;
 
-  int Bot::heuristicEvaluation(Move move, Move bestMove)
-  {
-    if (move == bestMove)
-      return INF_EVAL;
+    m_maxSearchTime = time;
+    {
+      // Clearing the cancellation under the timer's lock ensures a timeout left over from the previous search cannot cancel this one.
+      // A stop request is left alone, since it may have been sent for this search before it got here
+      std::lock_guard<std::mutex> lock(m_searchTimerMutex);
+      m_searchCancelled = false;
+      m_searchTimerReset = true;
+    }
+    m_searchTimerEvent.notify_one();
 
-    int evaluation = 0;
+    m_transpositionTable->newSearch();
+    m_moveHistory.newSearch();
 
-    uint8_t from = move & FROM;
-    uint8_t to = (move & TO) >> 6;
-    PieceType promotionPieceType = move >> 12;
+    startHelperThreads();
 
-    evaluation += PIECE_VALUES[m_board[to] & TYPE];
-    evaluation += PIECE_VALUES[promotionPieceType];
+    m_previousSearchInfo.bestMove = runIterativeDeepening(1);
 
-    evaluation += getPiecePositionalEvaluation(to, true) - getPiecePositionalEvaluation(from, true);
+    stopHelperThreads();
 
-    return evaluation;
+    return m_previousSearchInfo.bestMove;
   }
 
-  int Bot::getSortedLegalMoves(MoveAllocation& moves, bool onlyCaptures, Move bestMove)
+  Move Bot::runIterativeDeepening(int startDepth)
   {
-    int legalMovesCount = m_board.getLegalMoves(moves, onlyCaptures);
-    heuristicSortMoves(moves, std::min(legalMovesCount, m_botSettings.maxHeuristicSortedMoves), bestMove);
-    return legalMovesCount;
+    // Start from the best move of a previous search of this position (or another thread's), if any
+    TranspositionTable::Entry entry;
+    Move bestMove = NULL_MOVE;
+    if (m_transpositionTable->probe(m_board.zobristKey(), entry) && entry.move() != NULL_MOVE && m_board.isLegalMove(entry.move()))
+      bestMove = entry.move();
+
+    // The first iteration always starts, so that a search stopped right away still returns a legal move
+    for (int depth = startDepth; (depth == startDepth || !isSearchStopped()) && depth <= MAX_SEARCH_DEPTH; depth++)
+    {
+      Move newMove = aspirationSearch(depth, bestMove);
+
+      if (newMove == NULL_MOVE)
+        break;
+
+      bestMove = newMove;
+
+      // Mate scores count the plies to mate, mateIn counts the moves after the next one
+      int matePlies = INF_EVAL - abs(m_previousSearchInfo.evaluation);
+      if (m_previousSearchInfo.mateFound || m_previousSearchInfo.lossFound)
+        m_previousSearchInfo.mateIn = (matePlies - 1) / 2;
+
+      if (m_botSettings.logUCIInfo && !isSearchStopped())
+        logUCIInfo(bestMove);
+
+      // Every mate within the searched depth has been seen, so a deeper search cannot find a faster one
+      if ((m_previousSearchInfo.mateFound || m_previousSearchInfo.lossFound) && matePlies <= depth)
+        break;
+
+      if (m_searchLimits.maxDepth > 0 && depth >= m_searchLimits.maxDepth)
+        break;
+    }
+
+    return bestMove;
   }
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "bot/move_history.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace TungstenChess
+{
+  void MoveHistory::clear()
+  {
+    for (auto& killerMoves : m_killerMoves)
+      killerMoves.fill(NULL_MOVE);
+
+    for (auto& colorHistory : m_history)
+      for (auto& fromHistory : colorHistory)
+        fromHistory.fill(0);
+
+    for (auto& counterMoves : m_counterMoves)
+      counterMoves.fill(NULL_MOVE);
+  }
+
+  void MoveHistory::newSearch()
+  {
+    for (auto& killerMoves : m_killerMoves)
+      killerMoves.fill(NULL_MOVE);
+
+    for (auto& colorHistory : m_history)
+      for (auto& fromHistory : colorHistory)
+        for (int16_t& score : fromHistory)
+          score /= 2;
+  }
+
+  void MoveHistory::updateQuietCutoff(PieceColor color, int ply, int depth, Move previousMove, Move move, const Move* failedQuiets, int failedQuietsCount)
+  {
+    if (ply < MAX_PLY && m_killerMoves[ply][0] != move)
+    {
+      m_killerMoves[ply][1] = m_killerMoves[ply][0];
+      m_killerMoves[ply][0] = move;
+    }
+
+    if (previousMove != NULL_MOVE)
+      m_counterMoves[previousMove & FROM][(previousMove & TO) >> 6] = move;
+
+    int bonus = std::min(depth * depth * 32, MAX_HISTORY_BONUS);
+
+    updateHistory(color, move, bonus);
+
+    for (int i = 0; i < failedQuietsCount; i++)
+      updateHistory(color, failedQuiets[i], -bonus);
+  }
+
+  void MoveHistory::updateHistory(PieceColor color, Move move, int bonus)
+  {
+    int16_t& score = m_history[color == BLACK][move & FROM][(move & TO) >> 6];
+
+    score += bonus - score * std::abs(bonus) / MAX_HISTORY;
+  }
+}
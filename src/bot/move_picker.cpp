@@ -0,0 +1,230 @@
+#include "bot/move_picker.hpp"
+
+#include <algorithm>
+
+#include "bot/piece_eval_tables.hpp"
+
+namespace TungstenChess
+{
+  MovePicker::MovePicker(Board& board, MoveStack& moveStack, Move hashMove, bool onlyCaptures,
+                         const MoveHistory* moveHistory, int ply, Move previousMove)
+      : m_board(board),
+        m_moves(moveStack),
+        m_hashMove(hashMove),
+        m_onlyCaptures(onlyCaptures),
+        m_moveHistory(onlyCaptures ? nullptr : moveHistory)
+  {
+    m_refutations.fill(NULL_MOVE);
+
+    if (m_moveHistory)
+    {
+      for (int i = 0; i < MoveHistory::KILLER_MOVES_PER_PLY; i++)
+        m_refutations[i] = m_moveHistory->killerMove(ply, i);
+
+      m_refutations.back() = m_moveHistory->counterMove(previousMove);
+
+      for (size_t i = 0; i < m_refutations.size(); i++)
+      {
+        if (m_refutations[i] == m_hashMove || std::find(m_refutations.begin(), m_refutations.begin() + i, m_refutations[i]) != m_refutations.begin() + i)
+          m_refutations[i] = NULL_MOVE;
+      }
+    }
+
+    if (m_hashMove == NULL_MOVE ||
+        (m_onlyCaptures && !isCapture(m_hashMove)) ||
+        !m_board.isLegalMove(m_hashMove))
+    {
+      m_hashMove = NULL_MOVE;
+      m_stage = GENERATE_CAPTURES;
+    }
+  }
+
+  int MovePicker::generateAllMoves()
+  {
+    m_end = m_board.getLegalMoves(m_moves, m_onlyCaptures ? Board::CAPTURE_MOVES : Board::ALL_MOVES);
+
+    Move* moves = m_moves.begin();
+
+    for (size_t i = 0; i < m_end; i++)
+    {
+      if (moves[i] == m_hashMove)
+        m_scores[i] = INT32_MAX;
+      else if (isCapture(moves[i]))
+        m_scores[i] = scoreCapture(moves[i]);
+      else
+      {
+        auto refutation = std::find(m_refutations.begin(), m_refutations.end(), moves[i]);
+        m_scores[i] = refutation != m_refutations.end() ? REFUTATION_SCORE - (refutation - m_refutations.begin()) : scoreQuiet(moves[i]);
+      }
+    }
+
+    m_current = 0;
+    m_stage = ALL_MOVES;
+
+    return m_end;
+  }
+
+  Move MovePicker::next()
+  {
+    switch (m_stage)
+    {
+      case HASH_MOVE:
+        m_stage = GENERATE_CAPTURES;
+        return m_hashMove;
+
+      case GENERATE_CAPTURES:
+        generate(Board::CAPTURE_MOVES);
+        m_stage = GOOD_CAPTURES;
+        [[fallthrough]];
+
+      case GOOD_CAPTURES:
+        if (m_current < m_end)
+        {
+          if (selectBest() >= GOOD_CAPTURE_SCORE)
+            return m_moves.begin()[m_current++];
+        }
+
+        // The remaining captures all lose material, so they are deferred until after the quiet moves,
+        // and never searched in quiescence, where they would only inflate the search
+        m_badCapturesBegin = m_current;
+        m_badCapturesEnd = m_end;
+        m_current = m_end;
+
+        m_stage = m_onlyCaptures ? DONE : REFUTATIONS;
+        return next();
+
+      case REFUTATIONS:
+        while (m_currentRefutation < m_refutations.size())
+        {
+          Move& refutation = m_refutations[m_currentRefutation++];
+
+          // Refutations come from other positions, so they must be validated here
+          if (refutation == NULL_MOVE || isCapture(refutation) || !m_board.isLegalMove(refutation))
+            refutation = NULL_MOVE;
+          else
+            return refutation;
+        }
+
+        m_stage = GENERATE_QUIETS;
+        [[fallthrough]];
+
+      case GENERATE_QUIETS:
+        generate(Board::QUIET_MOVES);
+        m_stage = QUIETS;
+        [[fallthrough]];
+
+      case QUIETS:
+        if (m_current < m_end)
+        {
+          selectBest();
+          return m_moves.begin()[m_current++];
+        }
+
+        m_current = m_badCapturesBegin;
+        m_end = m_badCapturesEnd;
+
+        m_stage = BAD_CAPTURES;
+        [[fallthrough]];
+
+      case BAD_CAPTURES:
+      case ALL_MOVES:
+        if (m_current < m_end)
+        {
+          selectBest();
+          return m_moves.begin()[m_current++];
+        }
+
+        m_stage = DONE;
+        [[fallthrough]];
+
+      case DONE:
+      default:
+        return NULL_MOVE;
+    }
+  }
+
+  void MovePicker::generate(Board::MoveType moveType)
+  {
+    size_t begin = m_moves.size();
+    m_end = m_board.getLegalMoves(m_moves, moveType);
+
+    Move* moves = m_moves.begin();
+
+    for (size_t i = begin; i < m_end; i++)
+    {
+      if (isPicked(moves[i]))
+      {
+        moves[i--] = moves[--m_end];
+        m_moves.pop();
+        continue;
+      }
+
+      m_scores[i] = moveType == Board::CAPTURE_MOVES ? scoreCapture(moves[i]) : scoreQuiet(moves[i]);
+    }
+
+    m_current = begin;
+  }
+
+  bool MovePicker::isPicked(Move move) const
+  {
+    return move == m_hashMove || std::find(m_refutations.begin(), m_refutations.end(), move) != m_refutations.end();
+  }
+
+  int MovePicker::selectBest()
+  {
+    Move* moves = m_moves.begin();
+
+    size_t best = m_current;
+    for (size_t i = m_current + 1; i < m_end; i++)
+    {
+      if (m_scores[i] > m_scores[best])
+        best = i;
+    }
+
+    std::swap(moves[m_current], moves[best]);
+    std::swap(m_scores[m_current], m_scores[best]);
+
+    return m_scores[m_current];
+  }
+
+  int MovePicker::scoreCapture(Move move) const
+  {
+    Square from = move & FROM;
+    Square to = (move & TO) >> 6;
+    PieceType promotionPieceType = move >> 12;
+
+    PieceType attackerType = m_board[from] & TYPE;
+    PieceType victimType = m_board[to] ? m_board[to] & TYPE : PAWN; // en passant
+
+    int victimValue = PIECE_VALUES[victimType] + PIECE_VALUES[promotionPieceType];
+
+    int score = victimValue * PIECE_TYPE_NUMBER - attackerType;
+
+    if (m_board.staticExchangeEvaluation(move))
+      score += GOOD_CAPTURE_SCORE;
+
+    return score;
+  }
+
+  int MovePicker::scoreQuiet(Move move) const
+  {
+    Square from = move & FROM;
+    Square to = (move & TO) >> 6;
+    PieceType promotionPieceType = move >> 12;
+
+    Piece piece = m_board[from];
+
+    if (m_moveHistory)
+      return m_moveHistory->historyScore(piece & COLOR, move) + PIECE_VALUES[promotionPieceType] * QUIET_PROMOTION_MULTIPLIER;
+
+    return midgameScore(PIECE_EVAL_TABLES[piece][to]) - midgameScore(PIECE_EVAL_TABLES[piece][from]) + PIECE_VALUES[promotionPieceType];
+  }
+
+  bool MovePicker::isCapture(Move move) const
+  {
+    Square from = move & FROM;
+    Square to = (move & TO) >> 6;
+
+    return m_board[to] || ((m_board[from] & TYPE) == PAWN && (to - from) % 8);
+  }
+}
@@ -0,0 +1,241 @@
+#include "bot/nnue.hpp"
+
+#include <fstream>
+#include <random>
+
+#ifdef TUNGSTENCHESS_X86
+#include <immintrin.h>
+#endif
+
+#define NNUE_MAGIC 0x4E4E4354 // "TCNN" in little endian
+#define NNUE_VERSION 1
+
+namespace TungstenChess
+{
+  bool NNUE::loadNetwork(const std::filesystem::path& path)
+  {
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+      return false;
+
+    uint32_t magic = 0, version = 0, hiddenSize = 0;
+    file.read((char*)&magic, 4);
+    file.read((char*)&version, 4);
+    file.read((char*)&hiddenSize, 4);
+
+    if (!file || magic != NNUE_MAGIC || version != NNUE_VERSION || hiddenSize != HIDDEN_SIZE)
+      return false;
+
+    std::unique_ptr<Network> network(new Network);
+
+    file.read((char*)network->featureWeights.data(), sizeof(network->featureWeights));
+    file.read((char*)network->featureBiases.data(), sizeof(network->featureBiases));
+    file.read((char*)network->outputWeights.data(), sizeof(network->outputWeights));
+    file.read((char*)&network->outputBias, sizeof(network->outputBias));
+
+    // The file must contain exactly one network
+    if (!file || file.peek() != std::ifstream::traits_type::eof())
+      return false;
+
+    s_network = std::move(network);
+
+    return true;
+  }
+
+  void NNUE::generateRandomNetwork(uint64_t seed)
+  {
+    std::mt19937_64 random(seed);
+
+    // Kept small enough that no accumulator or output sum can overflow, whatever the position
+    std::uniform_int_distribution<int> featureWeight(-32, 32);
+    std::uniform_int_distribution<int> outputWeight(-64, 64);
+
+    std::unique_ptr<Network> network(new Network);
+
+    for (int16_t& weight : network->featureWeights)
+      weight = featureWeight(random);
+    for (int16_t& bias : network->featureBiases)
+      bias = featureWeight(random) * 4;
+    for (int16_t& weight : network->outputWeights)
+      weight = outputWeight(random);
+    network->outputBias = outputWeight(random) * QA;
+
+    s_network = std::move(network);
+  }
+
+  void NNUE::addFeature(std::array<int16_t, HIDDEN_SIZE>& values, int featureIndex)
+  {
+    s_kernels.addWeights(values.data(), &s_network->featureWeights[featureIndex * HIDDEN_SIZE]);
+  }
+
+  void NNUE::removeFeature(std::array<int16_t, HIDDEN_SIZE>& values, int featureIndex)
+  {
+    s_kernels.subtractWeights(values.data(), &s_network->featureWeights[featureIndex * HIDDEN_SIZE]);
+  }
+
+  void NNUE::updateAccumulator(Accumulator& accumulator, const std::array<Square, 2>& kingIndices, Square square, Piece oldPiece, Piece newPiece)
+  {
+    for (int perspective = 0; perspective < 2; perspective++)
+    {
+      Piece king = (perspective ? BLACK : WHITE) | KING;
+
+      // Every feature depends on the perspective's king square, so a king move invalidates the whole perspective
+      if (oldPiece == king || newPiece == king)
+        accumulator.dirty[perspective] = true;
+
+      if (accumulator.dirty[perspective])
+        continue;
+
+      // Kings are not input features, only the perspective's own king square is (as part of every feature)
+      if (oldPiece && (oldPiece & TYPE) != KING)
+        removeFeature(accumulator.values[perspective], Accumulator::getFeatureIndex(perspective, kingIndices[perspective], oldPiece, square));
+
+      if (newPiece && (newPiece & TYPE) != KING)
+        addFeature(accumulator.values[perspective], Accumulator::getFeatureIndex(perspective, kingIndices[perspective], newPiece, square));
+    }
+  }
+
+  void NNUE::refreshAccumulator(Accumulator& accumulator, int perspective, Square kingIndex, const std::array<Piece, 64>& board)
+  {
+    accumulator.values[perspective] = s_network->featureBiases;
+
+    for (Square square = 0; square < 64; square++)
+    {
+      if (board[square] && (board[square] & TYPE) != KING)
+        addFeature(accumulator.values[perspective], Accumulator::getFeatureIndex(perspective, kingIndex, board[square], square));
+    }
+
+    accumulator.dirty[perspective] = false;
+  }
+
+  int NNUE::evaluate(const Accumulator& accumulator, PieceColor sideToMove)
+  {
+    int us = sideToMove == WHITE ? 0 : 1;
+
+    const std::array<int16_t, HIDDEN_SIZE>* perspectives[2] = { &accumulator.values[us], &accumulator.values[us ^ 1] };
+
+    int32_t sum = 0;
+
+    for (int perspective = 0; perspective < 2; perspective++)
+      sum += s_kernels.activatedDotProduct(perspectives[perspective]->data(), &s_network->outputWeights[perspective * HIDDEN_SIZE]);
+
+    return (int64_t(sum) + s_network->outputBias) * SCALE / (QA * QB);
+  }
+
+  // Constant initialized to the kernels of the build flags and only upgraded during dynamic initialization, so the
+  // network can be used safely from other static initializers
+  NNUE::Kernels NNUE::s_kernels = { addWeights, subtractWeights, activatedDotProduct };
+  const bool NNUE::s_kernelsSelected = selectKernels();
+
+  bool NNUE::selectKernels()
+  {
+#ifdef TUNGSTENCHESS_X86
+    if (CpuFeatures::hasAvx2())
+      s_kernels = { addWeightsAvx2, subtractWeightsAvx2, activatedDotProductAvx2 };
+#endif
+
+    return true;
+  }
+
+  void NNUE::addWeights(int16_t* values, const int16_t* weights)
+  {
+#if defined(__SSE4_1__)
+    for (int i = 0; i < HIDDEN_SIZE; i += 8)
+    {
+      __m128i v = _mm_load_si128((const __m128i*)&values[i]);
+      __m128i w = _mm_load_si128((const __m128i*)&weights[i]);
+      _mm_store_si128((__m128i*)&values[i], _mm_add_epi16(v, w));
+    }
+#else
+    for (int i = 0; i < HIDDEN_SIZE; i++)
+      values[i] += weights[i];
+#endif
+  }
+
+  void NNUE::subtractWeights(int16_t* values, const int16_t* weights)
+  {
+#if defined(__SSE4_1__)
+    for (int i = 0; i < HIDDEN_SIZE; i += 8)
+    {
+      __m128i v = _mm_load_si128((const __m128i*)&values[i]);
+      __m128i w = _mm_load_si128((const __m128i*)&weights[i]);
+      _mm_store_si128((__m128i*)&values[i], _mm_sub_epi16(v, w));
+    }
+#else
+    for (int i = 0; i < HIDDEN_SIZE; i++)
+      values[i] -= weights[i];
+#endif
+  }
+
+  int32_t NNUE::activatedDotProduct(const int16_t* values, const int16_t* weights)
+  {
+#if defined(__SSE4_1__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ceiling = _mm_set1_epi16(QA);
+    __m128i sums = _mm_setzero_si128();
+
+    for (int i = 0; i < HIDDEN_SIZE; i += 8)
+    {
+      __m128i v = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)&values[i]), zero), ceiling);
+      __m128i w = _mm_load_si128((const __m128i*)&weights[i]);
+      sums = _mm_add_epi32(sums, _mm_madd_epi16(v, w));
+    }
+
+    sums = _mm_hadd_epi32(sums, sums);
+    sums = _mm_hadd_epi32(sums, sums);
+    return _mm_cvtsi128_si32(sums);
+#else
+    int32_t sum = 0;
+
+    for (int i = 0; i < HIDDEN_SIZE; i++)
+    {
+      int32_t activation = values[i] < 0 ? 0 : (values[i] > QA ? QA : values[i]);
+      sum += activation * weights[i];
+    }
+
+    return sum;
+#endif
+  }
+
+#ifdef TUNGSTENCHESS_X86
+  TUNGSTENCHESS_TARGET("avx2") void NNUE::addWeightsAvx2(int16_t* values, const int16_t* weights)
+  {
+    for (int i = 0; i < HIDDEN_SIZE; i += 16)
+    {
+      __m256i v = _mm256_load_si256((const __m256i*)&values[i]);
+      __m256i w = _mm256_load_si256((const __m256i*)&weights[i]);
+      _mm256_store_si256((__m256i*)&values[i], _mm256_add_epi16(v, w));
+    }
+  }
+
+  TUNGSTENCHESS_TARGET("avx2") void NNUE::subtractWeightsAvx2(int16_t* values, const int16_t* weights)
+  {
+    for (int i = 0; i < HIDDEN_SIZE; i += 16)
+    {
+      __m256i v = _mm256_load_si256((const __m256i*)&values[i]);
+      __m256i w = _mm256_load_si256((const __m256i*)&weights[i]);
+      _mm256_store_si256((__m256i*)&values[i], _mm256_sub_epi16(v, w));
+    }
+  }
+
+  TUNGSTENCHESS_TARGET("avx2") int32_t NNUE::activatedDotProductAvx2(const int16_t* values, const int16_t* weights)
+  {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ceiling = _mm256_set1_epi16(QA);
+    __m256i sums = _mm256_setzero_si256();
+
+    for (int i = 0; i < HIDDEN_SIZE; i += 16)
+    {
+      __m256i v = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)&values[i]), zero), ceiling);
+      __m256i w = _mm256_load_si256((const __m256i*)&weights[i]);
+      sums = _mm256_add_epi32(sums, _mm256_madd_epi16(v, w));
+    }
+
+    __m128i sums128 = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    sums128 = _mm_hadd_epi32(sums128, sums128);
+    sums128 = _mm_hadd_epi32(sums128, sums128);
+    return _mm_cvtsi128_si32(sums128);
+  }
+#endif
+}
@@ -6,8 +6,6 @@ namespace TungstenChess
   {
     std::ifstream file(path);
 
-    Zobrist::init();
-
     ZobristKey key = 0;
     for (int i = 0; i < 64; i++)
     {
@@ -18,7 +16,7 @@ namespace TungstenChess
         continue;
 
       Piece piece = (rawPiece & TYPE) | (WHITE << (rawPiece >> 3));
-      key ^= Zobrist::pieceKeys.at(piece, i);
+      key ^= Zobrist::pieceKey(piece, i);
     }
 
     uint8_t castlingRights;
@@ -34,6 +32,7 @@ namespace TungstenChess
     if (sideToMove == 0)
       key ^= Zobrist::sideKey;
 
+    m_bookZobristKey = key;
     m_inOpeningBook = (key == m_startingZobristKey);
 
     uint openingBookSize;
@@ -65,6 +64,15 @@ namespace TungstenChess
     file.close();
   }
 
+  void OpeningBook::reset(ZobristKey startingZobristKey)
+  {
+    m_startingZobristKey = startingZobristKey;
+
+    m_inOpeningBook = (m_bookZobristKey == m_startingZobristKey);
+    m_lastMoveIndex = -1;
+    m_moves.clear();
+  }
+
   bool OpeningBook::addMove(Move move)
   {
     if (!m_inOpeningBook)
@@ -1,5 +1,6 @@
 #include "bot/transposition_table.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
@@ -7,55 +8,122 @@ namespace TungstenChess
 {
   using Entry = TranspositionTable::Entry;
 
-  Entry::Entry(ZobristKey key, uint searchId, int evaluation, int depth, bool quiesce)
+  Entry::Entry(Move move, int evaluation, int depth, Bound bound, bool quiesce, uint8_t generation)
+      : m_data(uint64_t(uint32_t(evaluation)) << EVALUATION_SHIFT |
+               uint64_t(move) << MOVE_SHIFT |
+               uint64_t(uint8_t(depth)) << DEPTH_SHIFT |
+               uint64_t(generation & GENERATION_MASK) << GENERATION_SHIFT |
+               uint64_t(bound) << BOUND_SHIFT |
+               uint64_t(quiesce) << QUIESCE_SHIFT)
+  {}
+
+  void TranspositionTable::clear()
   {
-    overwrite(key, searchId, evaluation, depth, quiesce);
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+      for (Slot& slot : m_buckets[i].slots)
+      {
+        slot.keyXorData.store(0, std::memory_order_relaxed);
+        slot.data.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    m_generation = 0;
   }
 
-  void Entry::overwrite(ZobristKey key, uint searchId, int evaluation, int depth, bool quiesce)
+  int TranspositionTable::hashfull() const
   {
-    m_searchId = searchId;
-    m_key = key;
-    m_evaluation = evaluation;
-    m_depth = depth;
-    m_quiesce = quiesce;
+    const size_t sampleBuckets = std::min<size_t>(1000 / BUCKET_SIZE, BUCKET_COUNT);
+
+    int currentEntries = 0;
+
+    for (size_t i = 0; i < sampleBuckets; i++)
+    {
+      for (const Slot& slot : m_buckets[i].slots)
+      {
+        Entry entry(slot.data.load(std::memory_order_relaxed));
+        currentEntries += entry.isOccupied() && entry.generation() == m_generation;
+      }
+    }
+
+    return currentEntries * 1000 / (sampleBuckets * BUCKET_SIZE);
   }
 
   std::string TranspositionTable::occupancy() const
   {
     std::ostringstream ss;
-    ss << std::fixed << std::setprecision(2)
-       << (m_occupied * sizeof(Entry) / (double)MEGABYTE)
-       << " MB / "
-       << (TABLE_SIZE * sizeof(Entry) / (double)MEGABYTE)
+    ss << std::fixed << std::setprecision(1)
+       << (hashfull() / 10.0)
+       << "% of "
+       << (BUCKET_COUNT * sizeof(Bucket) / MEGABYTE)
        << " MB";
     return ss.str();
   }
 
-  bool TranspositionTable::hasEntry(ZobristKey key) const
+  bool TranspositionTable::probe(ZobristKey key, Entry& entry) const
   {
-    return m_transpositionTable[key % TABLE_SIZE].isSameKey(key);
-  }
+    const Bucket& keyBucket = bucket(key);
 
-  const Entry& TranspositionTable::retrieve(ZobristKey key, bool& found)
-  {
-    Entry& entry = m_transpositionTable[key % TABLE_SIZE];
-    found = entry.isSameKey(key);
-    return entry;
+    for (const Slot& slot : keyBucket.slots)
+    {
+      uint64_t data = slot.data.load(std::memory_order_relaxed);
+
+      if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key)
+      {
+        entry = Entry(data);
+        return entry.isOccupied();
+      }
+    }
+
+    return false;
   }
 
-  void TranspositionTable::store(ZobristKey key, uint searchId, int evaluation, int depth, bool quiesce)
+  void TranspositionTable::store(ZobristKey key, Move move, int evaluation, int depth, Bound bound, bool quiesce)
   {
-    Entry& entry = m_transpositionTable[key % TABLE_SIZE];
+    Bucket& keyBucket = bucket(key);
 
-    if (!entry.isOccupied())
-      m_occupied++;
+    Slot* replacedSlot = nullptr;
+    int lowestValue = INT32_MAX;
 
-    // Prefer newer, deeper, non-quiesce entries
-    if (!entry.isOccupied() ||
-        searchId - entry.searchId() >= 3 ||
-        depth > entry.depth() ||
-        (!quiesce && entry.quiesce()))
-      entry.overwrite(key, searchId, evaluation, depth, quiesce);
+    for (Slot& slot : keyBucket.slots)
+    {
+      uint64_t data = slot.data.load(std::memory_order_relaxed);
+      Entry entry(data);
+
+      if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key && entry.isOccupied())
+      {
+        if (move == NULL_MOVE)
+          move = entry.move();
+
+        // Keep a deeper entry from the current search unless the new result is exact
+        if (bound != EXACT_BOUND && entry.generation() == m_generation && entry.depth() > depth && entry.quiesce() == quiesce)
+          return;
+
+        replacedSlot = &slot;
+        break;
+      }
+
+      // Prefer replacing empty, old, shallow and quiescence entries
+      int value = INT32_MIN;
+      if (entry.isOccupied())
+      {
+        int age = (m_generation - entry.generation()) & Entry::GENERATION_MASK;
+        value = entry.depth() - 8 * age - (entry.quiesce() ? 64 : 0);
+      }
+
+      if (value < lowestValue)
+      {
+        lowestValue = value;
+        replacedSlot = &slot;
+      }
+    }
+
+    write(*replacedSlot, key, Entry(move, evaluation, depth, bound, quiesce, m_generation));
+  }
+
+  void TranspositionTable::write(Slot& slot, ZobristKey key, Entry entry)
+  {
+    slot.data.store(entry.data(), std::memory_order_relaxed);
+    slot.keyXorData.store(key ^ entry.data(), std::memory_order_relaxed);
   }
-}
\ No newline at end of file
+}
@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "core/cpu_features.hpp"
+
 namespace TungstenChess
 {
   namespace Bitboards
@@ -12,7 +14,28 @@ namespace TungstenChess
 
     bool hasBit(const Bitboard& bitboard, Square index) { return bitboard & bit(index); }
 
+#if defined(__POPCNT__) || !defined(TUNGSTENCHESS_X86)
     Square countBits(const Bitboard& bitboard) { return __builtin_popcountll(bitboard); }
+#else
+    // Without POPCNT in the build flags the builtin is a software bit count, so the instruction is selected at startup
+    static Square countBitsSoftware(Bitboard bitboard) { return __builtin_popcountll(bitboard); }
+    TUNGSTENCHESS_TARGET("popcnt") static Square countBitsPopcnt(Bitboard bitboard) { return __builtin_popcountll(bitboard); }
+
+    // Constant initialized to the software count so it is valid from other static initializers, then upgraded
+    static Square (*s_countBits)(Bitboard bitboard) = countBitsSoftware;
+
+    static bool selectCountBits()
+    {
+      if (CpuFeatures::hasPopcnt())
+        s_countBits = countBitsPopcnt;
+
+      return true;
+    }
+
+    static const bool s_countBitsSelected = selectCountBits();
+
+    Square countBits(const Bitboard& bitboard) { return s_countBits(bitboard); }
+#endif
 
     Bitboard file(const Bitboard& bitboard, File file) { return bitboard & (0x0101010101010101ULL << file); }
 
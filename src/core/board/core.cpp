@@ -1,31 +1,40 @@
 #include "core/board.hpp"
 
-#include "core/moves_lookup/magic.hpp"
+#include "bot/nnue.hpp"
 
 namespace TungstenChess
 {
   Board::Board(std::string fen)
       : m_positionHistory(MAX_GAME_LENGTH)
   {
-    Zobrist::init();
-    MagicMoveGen::init();
-
     resetBoard(fen);
   }
 
   Board::Board(const Board& other, size_t futureMoves)
-      : m_board(other.m_board),
-        m_bitboards(other.m_bitboards),
-        m_kingIndices(other.m_kingIndices),
-        m_pieceCounts(other.m_pieceCounts),
-        m_sideToMove(other.m_sideToMove),
-        m_castlingRights(other.m_castlingRights),
-        m_enPassantFile(other.m_enPassantFile),
-        m_hasCastled(other.m_hasCastled),
-        m_halfmoveClock(other.m_halfmoveClock),
-        m_zobristKey(other.m_zobristKey),
-        m_positionHistory(futureMoves, &other.m_positionHistory)
-  {}
+      : m_positionHistory(futureMoves, &other.m_positionHistory)
+  {
+    copyPosition(other);
+  }
+
+  void Board::copyPosition(const Board& other)
+  {
+    m_board = other.m_board;
+    m_bitboards = other.m_bitboards;
+    m_kingIndices = other.m_kingIndices;
+    m_pieceCounts = other.m_pieceCounts;
+    m_materials = other.m_materials;
+    m_positionalScore = other.m_positionalScore;
+    m_phase = other.m_phase;
+    m_accumulators.assign(1, other.accumulator());
+    m_accumulatorPly = 0;
+    m_sideToMove = other.m_sideToMove;
+    m_castlingRights = other.m_castlingRights;
+    m_enPassantFile = other.m_enPassantFile;
+    m_hasCastled = other.m_hasCastled;
+    m_halfmoveClock = other.m_halfmoveClock;
+    m_zobristKey = other.m_zobristKey;
+    m_pawnKey = other.m_pawnKey;
+  }
 
   void Board::resetBoard(std::string fen)
   {
@@ -56,9 +65,19 @@ namespace TungstenChess
 
     m_castlingRights = 0;
     m_enPassantFile = NO_EP;
-
-    for (Piece i = 0; i < ALL_PIECES + 1; i++)
-      m_bitboards[i] = 0;
+    m_hasCastled = 0;
+    m_halfmoveClock = fenParts[FEN_HALFMOVE_CLOCK].empty() ? 0 : std::stoi(fenParts[FEN_HALFMOVE_CLOCK]);
+
+    // updatePiece works incrementally, so everything it touches must start from an empty board
+    m_board.fill(NO_PIECE);
+    m_bitboards.fill(0);
+    m_pieceCounts.fill(0);
+    m_materials.fill(0);
+    m_positionalScore = 0;
+    m_phase = 0;
+    m_accumulators.resize(1);
+    m_accumulatorPly = 0;
+    resetAccumulator();
 
     m_sideToMove = WHITE;
 
@@ -113,10 +132,31 @@ namespace TungstenChess
     }
 
     m_zobristKey = calculateInitialZobristKey();
+    m_pawnKey = calculateInitialPawnKey();
 
+    m_positionHistory.stack.clear();
     m_positionHistory.stack.push(m_zobristKey);
   }
 
+  void Board::resetAccumulator()
+  {
+    for (NNUEAccumulator& accumulator : m_accumulators)
+      accumulator.dirty = { true, true };
+  }
+
+  int Board::getNNUEEvaluation()
+  {
+    NNUEAccumulator& accumulator = m_accumulators[m_accumulatorPly];
+
+    if (accumulator.dirty[0])
+      NNUE::refreshAccumulator(accumulator, 0, m_kingIndices[WHITE_KING], m_board);
+
+    if (accumulator.dirty[1])
+      NNUE::refreshAccumulator(accumulator, 1, m_kingIndices[BLACK_KING], m_board);
+
+    return NNUE::evaluate(accumulator, m_sideToMove);
+  }
+
   ZobristKey Board::calculateInitialZobristKey() const
   {
     ZobristKey zobristKey = 0;
@@ -125,7 +165,7 @@ namespace TungstenChess
     {
       if (m_board[i])
       {
-        zobristKey ^= Zobrist::pieceKeys.at(m_board[i], i);
+        zobristKey ^= Zobrist::pieceKey(m_board[i], i);
       }
     }
 
@@ -138,8 +178,32 @@ namespace TungstenChess
     return zobristKey;
   }
 
+  ZobristKey Board::calculateInitialPawnKey() const
+  {
+    ZobristKey pawnKey = 0;
+
+    for (Square i = 0; i < 64; i++)
+    {
+      if ((m_board[i] & TYPE) == PAWN)
+      {
+        pawnKey ^= Zobrist::pieceKey(m_board[i], i);
+      }
+    }
+
+    return pawnKey;
+  }
+
   Board Board::createBranch(size_t futureMoves) const
   {
     return Board(*this, futureMoves);
   }
+
+  void Board::rebranch(const Board& other)
+  {
+    copyPosition(other);
+
+    m_positionHistory.stack.clear();
+    m_positionHistory.prev = &other.m_positionHistory;
+    m_positionHistory.prevSize = other.m_positionHistory.stack.size();
+  }
 }
\ No newline at end of file
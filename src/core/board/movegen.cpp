@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include "bot/piece_eval_tables.hpp"
 #include "core/moves_lookup/lookup.hpp"
 #include "core/moves_lookup/magic.hpp"
 
@@ -23,7 +24,7 @@ namespace TungstenChess
 
       Bitboard captureSquares = m_bitboards[BLACK];
       captureSquares |= (0xFFULL & Bitboards::bit(m_enPassantFile)) << 16;
-      movesBitboard |= MovesLookup::PAWN_CAPTURE_MOVES.at(WHITE_PAWN, pieceIndex) & captureSquares;
+      movesBitboard |= MovesLookup::PAWN_CAPTURE_MOVES[WHITE_PAWN][pieceIndex] & captureSquares;
     }
     else if (color & BLACK)
     {
@@ -37,7 +38,7 @@ namespace TungstenChess
 
       Bitboard captureSquares = m_bitboards[WHITE];
       captureSquares |= (0xFFULL & Bitboards::bit(m_enPassantFile)) << 40;
-      movesBitboard |= MovesLookup::PAWN_CAPTURE_MOVES.at(BLACK_PAWN, pieceIndex) & captureSquares;
+      movesBitboard |= MovesLookup::PAWN_CAPTURE_MOVES[BLACK_PAWN][pieceIndex] & captureSquares;
     }
 
     return movesBitboard;
@@ -137,29 +138,78 @@ namespace TungstenChess
     return getPseudoLegalPieceMoves(pieceIndex, m_board[pieceIndex] & COLOR);
   }
 
-  Bitboard Board::getLegalPieceMovesBitboard(Square pieceIndex, PieceColor color, bool onlyCaptures)
+  Bitboard Board::getLegalPieceMovesBitboard(Square pieceIndex, PieceColor color, MoveType moveType)
   {
-    bool includeCastling = !onlyCaptures;
-    Bitboard pseudoLegalMovesBitboard = getPseudoLegalPieceMoves(pieceIndex, color, includeCastling);
+    return getLegalPieceMovesBitboard(pieceIndex, color, moveType, getCheckersBitboard(color), getPinnedPiecesBitboard(color));
+  }
+
+  Bitboard Board::getLegalPieceMovesBitboard(Square pieceIndex, PieceColor color, MoveType moveType, Bitboard checkers, Bitboard pinned)
+  {
+    PieceType pieceType = m_board[pieceIndex] & TYPE;
+
+    bool includeCastling = moveType != CAPTURE_MOVES && !checkers;
+    Bitboard movesBitboard = getPseudoLegalPieceMoves(pieceIndex, color, includeCastling);
+
+    Bitboard enPassantBitboard = 0;
+
+    if (pieceType == PAWN)
+    {
+      enPassantBitboard = movesBitboard & ((0xFFULL & Bitboards::bit(m_enPassantFile)) << (color & WHITE ? 16 : 40));
+      movesBitboard &= ~enPassantBitboard;
+    }
+
+    if (moveType == CAPTURE_MOVES)
+      movesBitboard &= m_bitboards[color ^ COLOR];
+    else if (moveType == QUIET_MOVES)
+    {
+      movesBitboard &= ~m_bitboards[color ^ COLOR];
+      enPassantBitboard = 0;
+    }
+
+    if (pieceType == KING)
+    {
+      Bitboard legalMovesBitboard = 0;
+
+      // The king must be removed from the occupancy so that it cannot hide from a slider behind itself
+      Bitboard occupiedWithoutKing = m_bitboards[ALL_PIECES] & ~Bitboards::bit(pieceIndex);
+
+      while (movesBitboard)
+      {
+        Square toIndex = Bitboards::popBit(movesBitboard);
+
+        if (!isAttacked(toIndex, color ^ COLOR, occupiedWithoutKing))
+          Bitboards::addBit(legalMovesBitboard, toIndex);
+      }
+
+      return legalMovesBitboard;
+    }
 
-    if (onlyCaptures)
-      pseudoLegalMovesBitboard &= m_bitboards[color ^ COLOR];
+    // In double check, only the king can move
+    if (checkers & (checkers - 1))
+      return 0;
 
-    Bitboard legalMovesBitboard = 0;
+    Square kingIndex = m_kingIndices[color | KING];
 
-    while (pseudoLegalMovesBitboard)
+    if (checkers)
+      movesBitboard &= checkers | MovesLookup::BETWEEN_MASKS[kingIndex][__builtin_ctzll(checkers)];
+
+    if (Bitboards::hasBit(pinned, pieceIndex))
+      movesBitboard &= MovesLookup::LINE_MASKS[kingIndex][pieceIndex];
+
+    // En passant removes two pieces from the board (possibly discovering a check along the rank), so it is validated by playing it
+    if (enPassantBitboard)
     {
-      Square toIndex = Bitboards::popBit(pseudoLegalMovesBitboard);
+      Square toIndex = __builtin_ctzll(enPassantBitboard);
 
       MoveFlags flag = quickMakeMove(pieceIndex, toIndex);
 
       if (!isInCheck(color))
-        Bitboards::addBit(legalMovesBitboard, toIndex);
+        movesBitboard |= enPassantBitboard;
 
       quickUnmakeMove(pieceIndex, toIndex, flag);
     }
 
-    return legalMovesBitboard;
+    return movesBitboard;
   }
 
   Bitboard Board::getLegalPieceMovesBitboard(Square pieceIndex)
@@ -167,6 +217,48 @@ namespace TungstenChess
     return getLegalPieceMovesBitboard(pieceIndex, m_board[pieceIndex] & COLOR);
   }
 
+  Bitboard Board::getCheckersBitboard(PieceColor color) const
+  {
+    Square kingIndex = m_kingIndices[color | KING];
+
+    const Bitboard* enemyBitboards = &m_bitboards[color ^ COLOR];
+
+    Bitboard checkersBitboard = 0;
+
+    checkersBitboard |= MovesLookup::KNIGHT_MOVES[kingIndex] & enemyBitboards[KNIGHT];
+    checkersBitboard |= MovesLookup::PAWN_CAPTURE_MOVES[color][kingIndex] & enemyBitboards[PAWN];
+
+    checkersBitboard |= MagicMoveGen::getBishopMoves(kingIndex, m_bitboards[ALL_PIECES]) & (enemyBitboards[BISHOP] | enemyBitboards[QUEEN]);
+    checkersBitboard |= MagicMoveGen::getRookMoves(kingIndex, m_bitboards[ALL_PIECES]) & (enemyBitboards[ROOK] | enemyBitboards[QUEEN]);
+
+    return checkersBitboard;
+  }
+
+  Bitboard Board::getPinnedPiecesBitboard(PieceColor color) const
+  {
+    Square kingIndex = m_kingIndices[color | KING];
+
+    const Bitboard* enemyBitboards = &m_bitboards[color ^ COLOR];
+
+    // Enemy sliders that would attack the king if the friendly pieces were removed
+    Bitboard snipersBitboard = (MagicMoveGen::getBishopMoves(kingIndex, enemyBitboards[0]) & (enemyBitboards[BISHOP] | enemyBitboards[QUEEN])) |
+                               (MagicMoveGen::getRookMoves(kingIndex, enemyBitboards[0]) & (enemyBitboards[ROOK] | enemyBitboards[QUEEN]));
+
+    Bitboard pinnedBitboard = 0;
+
+    while (snipersBitboard)
+    {
+      Square sniperIndex = Bitboards::popBit(snipersBitboard);
+
+      Bitboard blockersBitboard = MovesLookup::BETWEEN_MASKS[kingIndex][sniperIndex] & m_bitboards[ALL_PIECES];
+
+      if (blockersBitboard && !(blockersBitboard & (blockersBitboard - 1)))
+        pinnedBitboard |= blockersBitboard & m_bitboards[color];
+    }
+
+    return pinnedBitboard;
+  }
+
   Bitboard Board::getAttackingPiecesBitboard(Square targetSquare, Piece targetPiece, PieceColor color) const
   {
     Bitboard attackingPiecesBitboard = 0;
@@ -175,19 +267,19 @@ namespace TungstenChess
 
     if (targetPiece)
     {
-      Bitboard attackingPawns = MovesLookup::PAWN_CAPTURE_MOVES.at(color ^ COLOR, targetSquare) & friendlyBitboards[PAWN];
+      Bitboard attackingPawns = MovesLookup::PAWN_CAPTURE_MOVES[color ^ COLOR][targetSquare] & friendlyBitboards[PAWN];
       attackingPiecesBitboard |= attackingPawns;
     }
     else
     {
-      Bitboard reverseSinglePawnMoveSquare = MovesLookup::PAWN_REVERSE_SINGLE_MOVES.at(color, targetSquare);
+      Bitboard reverseSinglePawnMoveSquare = MovesLookup::PAWN_REVERSE_SINGLE_MOVES[color][targetSquare];
 
       Bitboard attackingSingleMovePawns = reverseSinglePawnMoveSquare & friendlyBitboards[PAWN];
       attackingPiecesBitboard |= attackingSingleMovePawns;
 
       if (!attackingSingleMovePawns && !(m_bitboards[ALL_PIECES] & reverseSinglePawnMoveSquare))
       {
-        Bitboard reverseDoublePawnMoveSquare = MovesLookup::PAWN_REVERSE_DOUBLE_MOVES.at(color, targetSquare);
+        Bitboard reverseDoublePawnMoveSquare = MovesLookup::PAWN_REVERSE_DOUBLE_MOVES[color][targetSquare];
 
         Bitboard attackingDoubleMovePawns = reverseDoublePawnMoveSquare & friendlyBitboards[PAWN];
         attackingPiecesBitboard |= attackingDoubleMovePawns;
@@ -209,60 +301,117 @@ namespace TungstenChess
     return attackingPiecesBitboard;
   }
 
-  int Board::getLegalMoves(MoveAllocation& legalMoves, bool onlyCaptures)
+  int Board::getLegalMoves(MoveAllocation& legalMoves, MoveType moveType)
   {
-    return getLegalMoves(legalMoves, m_sideToMove, onlyCaptures);
+    return getLegalMoves(legalMoves, m_sideToMove, moveType);
   }
 
-  int Board::getLegalMoves(MoveAllocation& legalMoves, PieceColor color, bool onlyCaptures)
+  bool Board::isLegalMove(Move move)
   {
-    Bitboard movablePiecesBitboard = 0;
-    Bitboard targetSquaresBitboard = 0;
+    Square from = move & FROM;
+    Square to = (move & TO) >> 6;
+    PieceType promotionPieceType = move >> 12;
 
-    const Bitboard* friendlyBitboards = &m_bitboards[color];
-    const Bitboard* enemyBitboards = &m_bitboards[color ^ COLOR];
+    Piece piece = m_board[from];
 
-    int kingIndex = m_kingIndices[color | KING];
+    if ((piece & COLOR) != m_sideToMove)
+      return false;
 
-    Bitboard attackingKnights = MovesLookup::KNIGHT_MOVES[kingIndex] & enemyBitboards[KNIGHT];
-    if (attackingKnights)
-    {
-      movablePiecesBitboard = friendlyBitboards[KING];
+    if (Moves::isPromotion(to, piece & TYPE) ? (promotionPieceType < KNIGHT || promotionPieceType > QUEEN) : promotionPieceType != NO_TYPE)
+      return false;
 
-      if (Bitboards::countBits(attackingKnights) == 1)
-        targetSquaresBitboard = attackingKnights;
-    }
-    else
+    return Bitboards::hasBit(getLegalPieceMovesBitboard(from, m_sideToMove), to);
+  }
+
+  Bitboard Board::getAttackersBitboard(Square square, Bitboard occupied) const
+  {
+    return (MovesLookup::PAWN_CAPTURE_MOVES[BLACK][square] & m_bitboards[WHITE_PAWN]) |
+           (MovesLookup::PAWN_CAPTURE_MOVES[WHITE][square] & m_bitboards[BLACK_PAWN]) |
+           (MovesLookup::KNIGHT_MOVES[square] & (m_bitboards[WHITE_KNIGHT] | m_bitboards[BLACK_KNIGHT])) |
+           (MovesLookup::KING_MOVES[square] & (m_bitboards[WHITE_KING] | m_bitboards[BLACK_KING])) |
+           (MagicMoveGen::getBishopMoves(square, occupied) & (m_bitboards[WHITE_BISHOP] | m_bitboards[BLACK_BISHOP] | m_bitboards[WHITE_QUEEN] | m_bitboards[BLACK_QUEEN])) |
+           (MagicMoveGen::getRookMoves(square, occupied) & (m_bitboards[WHITE_ROOK] | m_bitboards[BLACK_ROOK] | m_bitboards[WHITE_QUEEN] | m_bitboards[BLACK_QUEEN]));
+  }
+
+  bool Board::staticExchangeEvaluation(Move move, int threshold) const
+  {
+    Square from = move & FROM;
+    Square to = (move & TO) >> 6;
+
+    PieceType movingPieceType = m_board[from] & TYPE;
+
+    bool isEnPassant = movingPieceType == PAWN && (to - from) % 8 && !m_board[to];
+    if ((move & PROMOTION_PIECE) || isEnPassant)
+      return threshold <= 0;
+
+    // The balance is kept from the perspective of the side that made the last capture, and the exchange
+    // stops as soon as the side to recapture can no longer turn it in its favor
+    int balance = PIECE_VALUES[m_board[to] & TYPE] - threshold;
+    if (balance < 0)
+      return false;
+
+    balance = PIECE_VALUES[movingPieceType] - balance;
+    if (balance <= 0)
+      return true;
+
+    Bitboard occupied = m_bitboards[ALL_PIECES] ^ Bitboards::bit(from) ^ Bitboards::bit(to);
+    Bitboard attackers = getAttackersBitboard(to, occupied);
+
+    Bitboard diagonalSliders = m_bitboards[WHITE_BISHOP] | m_bitboards[BLACK_BISHOP] | m_bitboards[WHITE_QUEEN] | m_bitboards[BLACK_QUEEN];
+    Bitboard orthogonalSliders = m_bitboards[WHITE_ROOK] | m_bitboards[BLACK_ROOK] | m_bitboards[WHITE_QUEEN] | m_bitboards[BLACK_QUEEN];
+
+    PieceColor color = m_board[from] & COLOR;
+    bool result = true;
+
+    while (true)
     {
-      Bitboard diagonalMoves = MagicMoveGen::getBishopMoves(kingIndex, m_bitboards[ALL_PIECES]);
-      Bitboard orthogonalMoves = MagicMoveGen::getRookMoves(kingIndex, m_bitboards[ALL_PIECES]);
+      color ^= COLOR;
+      attackers &= occupied;
 
-      Bitboard attackingDiagonalSliders = diagonalMoves & (enemyBitboards[BISHOP] | enemyBitboards[QUEEN]);
-      Bitboard attackingOrthogonalSliders = orthogonalMoves & (enemyBitboards[ROOK] | enemyBitboards[QUEEN]);
+      Bitboard colorAttackers = attackers & m_bitboards[color];
+      if (!colorAttackers)
+        break;
 
-      if (!(attackingDiagonalSliders | attackingOrthogonalSliders))
-        movablePiecesBitboard = m_bitboards[color];
-      else
-      {
-        movablePiecesBitboard = friendlyBitboards[KING];
-        if (attackingDiagonalSliders)
-        {
-          targetSquaresBitboard = attackingDiagonalSliders |
-                                  (diagonalMoves & MovesLookup::BISHOP_MASKS[__builtin_ctzll(attackingDiagonalSliders)]);
-        }
-        else if (attackingOrthogonalSliders)
-        {
-          targetSquaresBitboard = attackingOrthogonalSliders |
-                                  (orthogonalMoves & MovesLookup::ROOK_MASKS[__builtin_ctzll(attackingOrthogonalSliders)]);
-        }
-      }
+      result = !result;
+
+      PieceType attackerType = PAWN;
+      while (!(colorAttackers & m_bitboards[color | attackerType]))
+        attackerType++;
+
+      // The king can only recapture if the opponent has no attackers left
+      if (attackerType == KING)
+        return (attackers & m_bitboards[color ^ COLOR]) ? !result : result;
+
+      balance = PIECE_VALUES[attackerType] - balance;
+      if (balance < result)
+        break;
+
+      Bitboard attackerBitboard = colorAttackers & m_bitboards[color | attackerType];
+      occupied ^= attackerBitboard & -attackerBitboard;
+
+      // Removing the attacker may reveal x-ray attackers behind it
+      if (attackerType == PAWN || attackerType == BISHOP || attackerType == QUEEN)
+        attackers |= MagicMoveGen::getBishopMoves(to, occupied) & diagonalSliders;
+      if (attackerType == ROOK || attackerType == QUEEN)
+        attackers |= MagicMoveGen::getRookMoves(to, occupied) & orthogonalSliders;
     }
 
+    return result;
+  }
+
+  int Board::getLegalMoves(MoveAllocation& legalMoves, PieceColor color, MoveType moveType)
+  {
+    Bitboard checkersBitboard = getCheckersBitboard(color);
+    Bitboard pinnedBitboard = getPinnedPiecesBitboard(color);
+
+    // In double check, only the king can move
+    Bitboard movablePiecesBitboard = (checkersBitboard & (checkersBitboard - 1)) ? m_bitboards[color | KING] : m_bitboards[color];
+
     while (movablePiecesBitboard)
     {
       Square pieceIndex = Bitboards::popBit(movablePiecesBitboard);
 
-      Bitboard movesBitboard = getLegalPieceMovesBitboard(pieceIndex, color, onlyCaptures);
+      Bitboard movesBitboard = getLegalPieceMovesBitboard(pieceIndex, color, moveType, checkersBitboard, pinnedBitboard);
 
       while (movesBitboard)
       {
@@ -282,42 +431,6 @@ namespace TungstenChess
       }
     }
 
-    if (onlyCaptures)
-      targetSquaresBitboard &= m_bitboards[color ^ COLOR];
-
-    while (targetSquaresBitboard)
-    {
-      Square targetSquare = Bitboards::popBit(targetSquaresBitboard);
-
-      Piece targetPiece = m_board[targetSquare];
-
-      Bitboard attackersBitboard = getAttackingPiecesBitboard(targetSquare, targetPiece, color);
-
-      while (attackersBitboard)
-      {
-        Square attackerIndex = Bitboards::popBit(attackersBitboard);
-
-        MoveFlags flag = quickMakeMove(attackerIndex, targetSquare);
-
-        if (!isInCheck(color))
-        {
-          legalMoves.push(Moves::createMove(attackerIndex, targetSquare));
-
-          Move& move = legalMoves.top();
-
-          if (flag & PROMOTION)
-          {
-            legalMoves.push(move | KNIGHT_PROMOTION);
-            legalMoves.push(move | BISHOP_PROMOTION);
-            legalMoves.push(move | ROOK_PROMOTION);
-            move |= QUEEN_PROMOTION;
-          }
-        }
-
-        quickUnmakeMove(attackerIndex, targetSquare, flag);
-      }
-    }
-
     return legalMoves.size();
   }
 
@@ -331,7 +444,7 @@ namespace TungstenChess
       return true;
 
     // look for pawns in the reverse direction
-    if (MovesLookup::PAWN_CAPTURE_MOVES.at(attackedColor, square) & attackerBitboards[PAWN])
+    if (MovesLookup::PAWN_CAPTURE_MOVES[attackedColor][square] & attackerBitboards[PAWN])
       return true;
 
     if (MovesLookup::KING_MOVES[square] & attackerBitboards[KING])
@@ -354,49 +467,163 @@ namespace TungstenChess
     return false;
   }
 
+  bool Board::isAttacked(Square square, PieceColor color, Bitboard occupied) const
+  {
+    PieceColor attackedColor = color ^ COLOR;
+
+    const Bitboard* attackerBitboards = &m_bitboards[color];
+
+    if (MovesLookup::KNIGHT_MOVES[square] & attackerBitboards[KNIGHT])
+      return true;
+
+    if (MovesLookup::PAWN_CAPTURE_MOVES[attackedColor][square] & attackerBitboards[PAWN])
+      return true;
+
+    if (MovesLookup::KING_MOVES[square] & attackerBitboards[KING])
+      return true;
+
+    if (MagicMoveGen::getRookMoves(square, occupied) & (attackerBitboards[ROOK] | attackerBitboards[QUEEN]))
+      return true;
+
+    if (MagicMoveGen::getBishopMoves(square, occupied) & (attackerBitboards[BISHOP] | attackerBitboards[QUEEN]))
+      return true;
+
+    return false;
+  }
+
   bool Board::isInCheck(PieceColor color) const
   {
     return isAttacked(m_kingIndices[color | KING], color ^ COLOR);
   }
 
-  bool Board::hasRepeatedThrice(ZobristKey key) const
+  ZobristKey Board::historyKey(int distance) const
   {
-    uint8_t count = 0;
-
     const DisjointZobristKeyStack* current = &m_positionHistory;
     size_t currentSize = current->stack.size();
 
-    while (current)
+    while (size_t(distance) >= currentSize)
     {
-      for (size_t i = currentSize - 1; i != SIZE_MAX; i--)
-      {
-        if (current->stack[i] == key && ++count == 3)
-          return true;
-      }
-
+      distance -= currentSize;
       currentSize = current->prevSize;
       current = current->prev;
     }
 
+    return current->stack[currentSize - 1 - distance];
+  }
+
+  int Board::maxRepetitionDistance() const
+  {
+    size_t historyLength = m_positionHistory.stack.size();
+
+    for (const DisjointZobristKeyStack* current = &m_positionHistory; current->prev; current = current->prev)
+      historyLength += current->prevSize;
+
+    return std::min<int>(m_halfmoveClock, historyLength - 1);
+  }
+
+  bool Board::isRepetition(int searchPly) const
+  {
+    int maxDistance = maxRepetitionDistance();
+
+    bool repeatedBeforeSearch = false;
+
+    // Only positions with the same side to move can repeat, and at least 4 plies are needed to return to one
+    for (int distance = 4; distance <= maxDistance; distance += 2)
+    {
+      if (historyKey(distance) != m_zobristKey)
+        continue;
+
+      if (distance < searchPly || repeatedBeforeSearch)
+        return true;
+
+      repeatedBeforeSearch = true;
+    }
+
+    return false;
+  }
+
+  bool Board::hasUpcomingRepetition(int searchPly) const
+  {
+    // Only positions after the root count, as positions from the game itself would need to occur thrice
+    int maxDistance = std::min(maxRepetitionDistance(), searchPly - 1);
+
+    if (maxDistance < 3)
+      return false;
+
+    // The combined key changes of the opponent's moves since each earlier position
+    ZobristKey opponentMovesKey = m_zobristKey ^ historyKey(1) ^ Zobrist::sideKey;
+
+    for (int distance = 3; distance <= maxDistance; distance += 2)
+    {
+      opponentMovesKey ^= historyKey(distance - 1) ^ historyKey(distance) ^ Zobrist::sideKey;
+
+      // Unless the opponent's moves cancel out, no single move of the side to move can return to the position
+      if (opponentMovesKey != 0)
+        continue;
+
+      ZobristKey moveKey = m_zobristKey ^ historyKey(distance);
+
+      int index = ZobristGenerator::cuckooIndex1(moveKey);
+      if (Zobrist::cuckooTables.keys[index] != moveKey)
+        index = ZobristGenerator::cuckooIndex2(moveKey);
+      if (Zobrist::cuckooTables.keys[index] != moveKey)
+        continue;
+
+      Move move = Zobrist::cuckooTables.moves[index];
+
+      if (!(MovesLookup::BETWEEN_MASKS[move & FROM][(move & TO) >> 6] & m_bitboards[ALL_PIECES]))
+        return true;
+    }
+
     return false;
   }
 
   Board::GameStatus Board::getGameStatus(PieceColor color)
   {
-    if (hasRepeatedThrice(m_zobristKey))
+    if (isRepetition())
       return STALEMATE;
 
-    Bitboard friendlyPiecesBitboard = m_bitboards[color];
+    if (hasAnyLegalMove(color))
+      return m_halfmoveClock >= 100 ? STALEMATE : NO_MATE;
+
+    return isInCheck(color) ? LOSE : STALEMATE;
+  }
+
+  bool Board::hasAnyLegalMove(PieceColor color)
+  {
+    Square kingIndex = m_kingIndices[color | KING];
+
+    // Castling never needs to be tried - if it is legal, so is the king's step onto the square it passes through
+    Bitboard kingMovesBitboard = MovesLookup::KING_MOVES[kingIndex] & ~m_bitboards[color];
+
+    // The king must be removed from the occupancy so that it cannot hide from a slider behind itself
+    Bitboard occupiedWithoutKing = m_bitboards[ALL_PIECES] & ~Bitboards::bit(kingIndex);
+
+    while (kingMovesBitboard)
+    {
+      if (!isAttacked(Bitboards::popBit(kingMovesBitboard), color ^ COLOR, occupiedWithoutKing))
+        return true;
+    }
+
+    Bitboard checkersBitboard = getCheckersBitboard(color);
+
+    // In double check, only the king can move
+    if (checkersBitboard & (checkersBitboard - 1))
+      return false;
+
+    Bitboard pinnedBitboard = getPinnedPiecesBitboard(color);
+
+    Bitboard friendlyPiecesBitboard = m_bitboards[color] & ~Bitboards::bit(kingIndex);
 
     while (friendlyPiecesBitboard)
     {
       Square pieceIndex = Bitboards::popBit(friendlyPiecesBitboard);
 
-      if (getLegalPieceMovesBitboard(pieceIndex))
-        return m_halfmoveClock >= 100 ? STALEMATE : NO_MATE;
+      if (getLegalPieceMovesBitboard(pieceIndex, color, ALL_MOVES, checkersBitboard, pinnedBitboard))
+        return true;
     }
 
-    return isInCheck(color) ? LOSE : STALEMATE;
+    return false;
   }
 
   uint64_t Board::countGames(uint8_t depth, bool verbose)
@@ -413,7 +640,7 @@ namespace TungstenChess
     MoveAllocation legalMoves(moveStack);
     int legalMovesCount = getLegalMoves(legalMoves, m_sideToMove);
 
-    uint games = 0;
+    uint64_t games = 0;
 
     for (int i = 0; i < legalMovesCount; i++)
     {
@@ -1,5 +1,8 @@
 #include "core/board.hpp"
 
+#include "bot/nnue.hpp"
+#include "bot/piece_eval_tables.hpp"
+
 namespace TungstenChess
 {
   Board::UnmoveData Board::makeMove(Move move)
@@ -26,6 +29,8 @@ namespace TungstenChess
     if (m_board[to] || pieceType == PAWN)
       m_halfmoveClock = 0;
 
+    pushAccumulator();
+
     movePiece(from, to, promotionPieceType | pieceColor);
 
     updateEnPassantFile(flags & PAWN_DOUBLE ? to % 8 : NO_EP);
@@ -83,6 +88,8 @@ namespace TungstenChess
 
     m_halfmoveClock = halfmoveClock;
 
+    popAccumulator();
+
     unmovePiece(from, to, piece, capturedPiece);
 
     if (flags & CASTLE)
@@ -99,7 +106,32 @@ namespace TungstenChess
     updateCastlingRights(castlingRights);
 
     if (flags & EP_CAPTURE)
-      updatePiece((piece & WHITE) ? to + 8 : to - 8, piece ^ COLOR);
+      updatePiece((piece & WHITE) ? to + 8 : to - 8, piece ^ COLOR, false);
+  }
+
+  Board::UnmoveData Board::makeNullMove()
+  {
+    UnmoveData unmoveData = { NO_PIECE, NO_PIECE, m_castlingRights, m_enPassantFile, m_halfmoveClock, NORMAL };
+
+    switchSideToMove();
+    updateEnPassantFile(NO_EP);
+
+    // Passing is not a legal move, so repetitions must not be detected across it
+    m_halfmoveClock = 0;
+
+    m_positionHistory.stack.push(m_zobristKey);
+
+    return unmoveData;
+  }
+
+  void Board::unmakeNullMove(UnmoveData unmoveData)
+  {
+    m_positionHistory.stack.pop();
+
+    switchSideToMove();
+    updateEnPassantFile(unmoveData.enPassantFile);
+
+    m_halfmoveClock = unmoveData.halfmoveClock;
   }
 
   void Board::updateBitboards(Square pieceIndex, Piece oldPiece, Piece newPiece)
@@ -202,14 +234,31 @@ namespace TungstenChess
     }
   }
 
-  void Board::updatePiece(Square pieceIndex, Piece newPiece)
+  void Board::updatePiece(Square pieceIndex, Piece newPiece, bool updateAccumulator)
   {
     Piece oldPiece = m_board[pieceIndex];
 
     m_pieceCounts[oldPiece]--;
     m_pieceCounts[newPiece]++;
 
-    m_zobristKey ^= Zobrist::getPieceCombinationKey(pieceIndex, oldPiece, newPiece);
+    // The sums are kept up to date here so that unmaking a move restores them for free
+    m_materials[oldPiece & COLOR] -= PIECE_VALUES[oldPiece & TYPE];
+    m_materials[newPiece & COLOR] += PIECE_VALUES[newPiece & TYPE];
+
+    m_positionalScore -= (oldPiece & WHITE ? 1 : -1) * PIECE_EVAL_TABLES[oldPiece][pieceIndex];
+    m_positionalScore += (newPiece & WHITE ? 1 : -1) * PIECE_EVAL_TABLES[newPiece][pieceIndex];
+
+    m_phase += PHASE_WEIGHTS[newPiece & TYPE] - PHASE_WEIGHTS[oldPiece & TYPE];
+
+    m_zobristKey ^= Zobrist::pieceKey(oldPiece, pieceIndex) ^ Zobrist::pieceKey(newPiece, pieceIndex);
+
+    if ((oldPiece & TYPE) == PAWN)
+      m_pawnKey ^= Zobrist::pieceKey(oldPiece, pieceIndex);
+    if ((newPiece & TYPE) == PAWN)
+      m_pawnKey ^= Zobrist::pieceKey(newPiece, pieceIndex);
+
+    if (updateAccumulator && NNUE::isLoaded())
+      NNUE::updateAccumulator(m_accumulators[m_accumulatorPly], { m_kingIndices[WHITE_KING], m_kingIndices[BLACK_KING] }, pieceIndex, oldPiece, newPiece);
 
     m_kingIndices[newPiece] = pieceIndex;
     m_board[pieceIndex] = newPiece;
@@ -217,6 +266,27 @@ namespace TungstenChess
     updateBitboards(pieceIndex, oldPiece, newPiece);
   }
 
+  void Board::pushAccumulator()
+  {
+    if (++m_accumulatorPly == m_accumulators.size())
+      m_accumulators.emplace_back();
+
+    // Without a network the values are never read, so only the stale flags are carried over
+    if (NNUE::isLoaded())
+      m_accumulators[m_accumulatorPly] = m_accumulators[m_accumulatorPly - 1];
+    else
+      m_accumulators[m_accumulatorPly].dirty = { true, true };
+  }
+
+  void Board::popAccumulator()
+  {
+    // Moves made before the board was reset or branched have no accumulator to return to
+    if (m_accumulatorPly == 0)
+      m_accumulators[0].dirty = { true, true };
+    else
+      m_accumulatorPly--;
+  }
+
   void Board::movePiece(Square from, Square to, Piece promotionPiece)
   {
     updatePiece(to, (promotionPiece & TYPE) == NO_TYPE ? m_board[from] : promotionPiece);
@@ -225,8 +295,8 @@ namespace TungstenChess
 
   void Board::unmovePiece(Square from, Square to, Piece movedPiece, Piece capturedPiece)
   {
-    updatePiece(from, movedPiece == NO_PIECE ? m_board[to] : movedPiece);
-    updatePiece(to, capturedPiece);
+    updatePiece(from, movedPiece == NO_PIECE ? m_board[to] : movedPiece, false);
+    updatePiece(to, capturedPiece, false);
   }
 
   void Board::removeCastlingRights(uint8_t rights)
@@ -0,0 +1,41 @@
+#include "core/cpu_features.hpp"
+
+namespace TungstenChess
+{
+  std::string CpuFeatures::describe()
+  {
+    std::string description;
+
+    if (hasPopcnt())
+      description += "popcnt ";
+    if (hasBmi2())
+      description += hasFastPext() ? "bmi2 " : "bmi2 (slow pext) ";
+    if (hasAvx2())
+      description += "avx2 ";
+
+    return description.empty() ? "none" : description.substr(0, description.size() - 1);
+  }
+
+  const CpuFeatures::Features& CpuFeatures::features()
+  {
+    static const Features detectedFeatures = detect();
+    return detectedFeatures;
+  }
+
+  CpuFeatures::Features CpuFeatures::detect()
+  {
+    Features detectedFeatures;
+
+#ifdef TUNGSTENCHESS_X86
+    // Detection may run from a static initializer, before the runtime has initialized the CPU model
+    __builtin_cpu_init();
+
+    detectedFeatures.popcnt = __builtin_cpu_supports("popcnt");
+    detectedFeatures.bmi2 = __builtin_cpu_supports("bmi2");
+    detectedFeatures.avx2 = __builtin_cpu_supports("avx2");
+    detectedFeatures.slowPext = __builtin_cpu_is("znver1") || __builtin_cpu_is("znver2");
+#endif
+
+    return detectedFeatures;
+  }
+}
@@ -1,155 +1,142 @@
 #include "core/moves_lookup/magic.hpp"
 
-#include "core/moves_lookup/lookup.hpp"
-#include "utils/utils.hpp"
+#ifdef TUNGSTENCHESS_X86
+#include <immintrin.h>
+#endif
 
 namespace TungstenChess
 {
-  void MagicMoveGen::init()
+  static constexpr size_t tableSizesSum(const Shift (&shifts)[64])
   {
-    static utils::once<false> initialized;
-    if (initialized)
-      return;
-
-    MovesLookup::init();
-
-    initRookLookupTables();
-    initBishopLookupTables();
+    size_t sum = 0;
+    for (Shift shift : shifts)
+      sum += size_t(1) << (64 - shift);
+    return sum;
   }
 
-  Bitboard MagicMoveGen::getBishopMoves(Square square, Bitboard allPieces)
+  static constexpr size_t pextTableSizesSum(const std::array<Bitboard, 64>& masks)
   {
-    Bitboard maskedPieces = allPieces & MovesLookup::BISHOP_MASKS[square];
-    return BISHOP_LOOKUP_TABLES.at(square, (BISHOP_MAGICS[square] * (maskedPieces)) >> BISHOP_SHIFTS[square]);
-  }
-
-  Bitboard MagicMoveGen::getRookMoves(Square square, Bitboard allPieces)
-  {
-    Bitboard maskedPieces = allPieces & MovesLookup::ROOK_MASKS[square];
-    return ROOK_LOOKUP_TABLES.at(square, (ROOK_MAGICS[square] * maskedPieces) >> ROOK_SHIFTS[square]);
+    size_t sum = 0;
+    for (Bitboard mask : masks)
+      sum += size_t(1) << __builtin_popcountll(mask);
+    return sum;
   }
 
-  void MagicMoveGen::getAllBlockers(std::vector<Bitboard>& blockers, Bitboard mask)
+  template <size_t Size>
+  constexpr void MagicMoveGen::generateSliderTables(AttackTables<Size>& tables, std::array<uint32_t, 64>& offsets, uint32_t start,
+                                                    const MovesLookup::SquareTable& masks, const Magic (&magics)[64], const Shift (&shifts)[64],
+                                                    const int (&directions)[4], bool pextIndexed)
   {
-    blockers.clear();
+    // Raw pointers keep the inner loop free of calls, which count heavily against the compiler's constexpr evaluation limits
+    Bitboard* attacks = tables.attacks.data();
+    uint32_t offset = start;
 
-    std::vector<Square> setBits;
-
-    for (Square i = 0; i < 64; i++)
-      if (mask & Bitboards::bit(i))
-        setBits.push_back(i);
-
-    for (int i = 0; i < (1 << setBits.size()); i++)
+    for (Square square = 0; square < 64; square++)
     {
-      Bitboard blocker = 0;
+      offsets[square] = offset;
 
-      for (size_t j = 0; j < setBits.size(); j++)
-        if (i & (1 << j))
-          blocker |= Bitboards::bit(setBits[j]);
+      const Bitboard* directionRays[4] = {};
+      bool isPositive[4] = {};
 
-      blockers.push_back(blocker);
-    }
-  }
+      for (int i = 0; i < 4; i++)
+      {
+        directionRays[i] = MovesLookup::RAYS[directions[i]].data();
+        isPositive[i] = MovesLookup::isPositiveDirection(directions[i]);
+      }
 
-  Bitboard MagicMoveGen::getRookMovesBitboard(Square square, Bitboard blockers)
-  {
-    Bitboard movesBitboard = 0;
+      Bitboard mask = masks[square];
+      Magic magic = magics[square];
+      Shift shift = shifts[square];
 
-    int directions[4] = { -8, -1, 1, 8 };
-    int rankEdges[4] = { 0, -1, -1, 7 };
-    int fileEdges[4] = { -1, 0, 7, -1 };
+      // Enumerates every subset of the mask (Carry-Rippler), ending when it wraps around to the empty set. The subsets
+      // come in increasing order of their compressed value, so a subset's index is exactly what PEXT extracts from it
+      Bitboard blockers = 0;
+      uint32_t subsetIndex = 0;
+      do
+      {
+        Bitboard movesBitboard = 0;
 
-    for (int i = 0; i < 4; i++)
-    {
-      Square to = square;
+        for (int i = 0; i < 4; i++)
+        {
+          Bitboard ray = directionRays[i][square];
+          Bitboard rayBlockers = ray & blockers;
 
-      while (true)
-      {
-        movesBitboard |= Bitboards::bit(to);
+          // Everything beyond the nearest blocker is the blocker's own ray in the same direction
+          if (rayBlockers)
+            ray ^= directionRays[i][isPositive[i] ? __builtin_ctzll(rayBlockers) : 63 - __builtin_clzll(rayBlockers)];
 
-        bool isEdge = (to / 8 == rankEdges[i]) || (to % 8 == fileEdges[i]);
+          movesBitboard |= ray;
+        }
 
-        if (isEdge || (blockers & Bitboards::bit(to)))
-          break;
+        attacks[offset + (pextIndexed ? subsetIndex : (blockers * magic) >> shift)] = movesBitboard;
+        blockers = (blockers - mask) & mask;
+        subsetIndex++;
+      } while (blockers);
 
-        to += directions[i];
-      }
+      offset += pextIndexed ? subsetIndex : uint32_t(1) << (64 - shift);
     }
-
-    return movesBitboard & ~Bitboards::bit(square);
   }
 
-  Bitboard MagicMoveGen::getBishopMovesBitboard(Square square, Bitboard blockers)
+  template <typename Tables>
+  constexpr Tables MagicMoveGen::generateAttackTables(bool pextIndexed)
   {
-    Bitboard movesBitboard = 0;
+    static_assert(ROOK_TABLE_SIZE == tableSizesSum(ROOK_SHIFTS), "ROOK_TABLE_SIZE does not match ROOK_SHIFTS");
+    static_assert(BISHOP_TABLE_SIZE == tableSizesSum(BISHOP_SHIFTS), "BISHOP_TABLE_SIZE does not match BISHOP_SHIFTS");
+    static_assert(ROOK_PEXT_TABLE_SIZE == pextTableSizesSum(MovesLookup::ROOK_MASKS), "ROOK_PEXT_TABLE_SIZE does not match ROOK_MASKS");
+    static_assert(BISHOP_PEXT_TABLE_SIZE == pextTableSizesSum(MovesLookup::BISHOP_MASKS), "BISHOP_PEXT_TABLE_SIZE does not match BISHOP_MASKS");
 
-    int directions[4] = { -9, -7, 7, 9 };
-    int rankEdges[4] = { 0, 0, 7, 7 };
-    int fileEdges[4] = { 0, 7, 0, 7 };
+    Tables tables;
 
-    for (int i = 0; i < 4; i++)
-    {
-      Square to = square;
+    uint32_t bishopStart = pextIndexed ? ROOK_PEXT_TABLE_SIZE : ROOK_TABLE_SIZE;
 
-      while (true)
-      {
-        movesBitboard |= Bitboards::bit(to);
-
-        bool isEdge = (to / 8 == rankEdges[i]) || (to % 8 == fileEdges[i]);
-
-        if (isEdge || (blockers & Bitboards::bit(to)))
-          break;
-
-        to += directions[i];
-      }
-    }
+    generateSliderTables(tables, tables.rookOffsets, 0, MovesLookup::ROOK_MASKS, ROOK_MAGICS, ROOK_SHIFTS, MovesLookup::ROOK_DIRECTIONS, pextIndexed);
+    generateSliderTables(tables, tables.bishopOffsets, bishopStart, MovesLookup::BISHOP_MASKS, BISHOP_MAGICS, BISHOP_SHIFTS, MovesLookup::BISHOP_DIRECTIONS, pextIndexed);
 
-    return movesBitboard & ~Bitboards::bit(square);
+    return tables;
   }
 
-  void MagicMoveGen::initRookLookupTables()
-  {
-    std::array<size_t, 64> rowSizes;
-    for (Square square = 0; square < 64; square++)
-    {
-      rowSizes[square] = 1U << (64 - ROOK_SHIFTS[square]);
-    }
-    ROOK_LOOKUP_TABLES.reserve(rowSizes);
+  // Only this translation unit evaluates the tables, the others see the declarations alone
+  constexpr MagicMoveGen::MagicAttackTables MagicMoveGen::MAGIC_ATTACK_TABLES = generateAttackTables<MagicAttackTables>(false);
+#ifdef TUNGSTENCHESS_X86
+  constexpr MagicMoveGen::PextAttackTables MagicMoveGen::PEXT_ATTACK_TABLES = generateAttackTables<PextAttackTables>(true);
+#endif
 
-    std::vector<Bitboard> blockers;
+  // Constant initialized to the magic kernels, so slider moves are valid even from other static initializers, and
+  // only upgraded once this translation unit is dynamically initialized
+  MagicMoveGen::SliderKernels MagicMoveGen::s_sliderKernels = { getBishopMagicMoves, getRookMagicMoves };
+  const bool MagicMoveGen::s_sliderKernelsSelected = selectSliderKernels();
 
-    for (Square square = 0; square < 64; square++)
-    {
-      getAllBlockers(blockers, MovesLookup::ROOK_MASKS[square]);
+  bool MagicMoveGen::selectSliderKernels()
+  {
+#ifdef TUNGSTENCHESS_X86
+    if (CpuFeatures::hasFastPext())
+      s_sliderKernels = { getBishopPextMoves, getRookPextMoves };
+#endif
 
-      for (size_t i = 0; i < blockers.size(); i++)
-      {
-        Bitboard shiftedBlockers = (blockers[i] * ROOK_MAGICS[square]) >> ROOK_SHIFTS[square];
-        ROOK_LOOKUP_TABLES.at(square, shiftedBlockers) = getRookMovesBitboard(square, blockers[i]);
-      }
-    }
+    return true;
   }
 
-  void MagicMoveGen::initBishopLookupTables()
+  Bitboard MagicMoveGen::getBishopMagicMoves(Square square, Bitboard allPieces)
   {
-    std::array<size_t, 64> rowSizes;
-    for (Square square = 0; square < 64; square++)
-    {
-      rowSizes[square] = 1 << (64 - BISHOP_SHIFTS[square]);
-    }
-    BISHOP_LOOKUP_TABLES.reserve(rowSizes);
+    Bitboard maskedPieces = allPieces & MovesLookup::BISHOP_MASKS[square];
+    return MAGIC_ATTACK_TABLES.attacks[MAGIC_ATTACK_TABLES.bishopOffsets[square] + ((BISHOP_MAGICS[square] * maskedPieces) >> BISHOP_SHIFTS[square])];
+  }
 
-    std::vector<Bitboard> blockers;
+  Bitboard MagicMoveGen::getRookMagicMoves(Square square, Bitboard allPieces)
+  {
+    Bitboard maskedPieces = allPieces & MovesLookup::ROOK_MASKS[square];
+    return MAGIC_ATTACK_TABLES.attacks[MAGIC_ATTACK_TABLES.rookOffsets[square] + ((ROOK_MAGICS[square] * maskedPieces) >> ROOK_SHIFTS[square])];
+  }
 
-    for (Square square = 0; square < 64; square++)
-    {
-      getAllBlockers(blockers, MovesLookup::BISHOP_MASKS[square]);
+#ifdef TUNGSTENCHESS_X86
+  TUNGSTENCHESS_TARGET("bmi2") Bitboard MagicMoveGen::getBishopPextMoves(Square square, Bitboard allPieces)
+  {
+    return PEXT_ATTACK_TABLES.attacks[PEXT_ATTACK_TABLES.bishopOffsets[square] + _pext_u64(allPieces, MovesLookup::BISHOP_MASKS[square])];
+  }
 
-      for (size_t i = 0; i < blockers.size(); i++)
-      {
-        Bitboard shiftedBlockers = (blockers[i] * BISHOP_MAGICS[square]) >> BISHOP_SHIFTS[square];
-        BISHOP_LOOKUP_TABLES.at(square, shiftedBlockers) = getBishopMovesBitboard(square, blockers[i]);
-      }
-    }
+  TUNGSTENCHESS_TARGET("bmi2") Bitboard MagicMoveGen::getRookPextMoves(Square square, Bitboard allPieces)
+  {
+    return PEXT_ATTACK_TABLES.attacks[PEXT_ATTACK_TABLES.rookOffsets[square] + _pext_u64(allPieces, MovesLookup::ROOK_MASKS[square])];
   }
-}
\ No newline at end of file
+#endif
+}
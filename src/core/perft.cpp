@@ -0,0 +1,132 @@
+#include "core/perft.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#define MEGABYTE 1048576
+
+namespace TungstenChess
+{
+  Perft::Perft(int threadCount, size_t hashSizeMB)
+      : m_threadCount(std::max(threadCount, 1)),
+        ENTRY_COUNT(hashSizeMB * MEGABYTE / sizeof(Entry)),
+        m_entries(ENTRY_COUNT ? new Entry[ENTRY_COUNT]() : nullptr)
+  {}
+
+  uint64_t Perft::run(const Board& board, int depth, bool verbose)
+  {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Board root = board.createBranch();
+
+    MoveStack rootMoveStack(MAX_LEGAL_MOVE_COUNT);
+    MoveAllocation rootMoves(rootMoveStack);
+    int rootMovesCount = depth > 0 ? root.getLegalMoves(rootMoves) : 0;
+
+    std::vector<uint64_t> rootMoveCounts(rootMovesCount);
+    std::atomic<int> nextRootMove = 0;
+
+    // Each thread takes the next unsearched root move until none remain, so that uneven subtrees balance out
+    auto worker = [&]()
+    {
+      Board branch = board.createBranch();
+      MoveStack moveStack(depth * MAX_LEGAL_MOVE_COUNT);
+
+      for (int i = nextRootMove++; i < rootMovesCount; i = nextRootMove++)
+      {
+        Board::UnmoveData unmoveData = branch.makeMove(rootMoves[i]);
+        rootMoveCounts[i] = countNodes(branch, moveStack, depth - 1);
+        branch.unmakeMove(rootMoves[i], unmoveData);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < std::min(m_threadCount, rootMovesCount); i++)
+      threads.emplace_back(worker);
+
+    worker();
+
+    for (std::thread& thread : threads)
+      thread.join();
+
+    uint64_t nodes = depth > 0 ? 0 : 1;
+    for (uint64_t count : rootMoveCounts)
+      nodes += count;
+
+    if (verbose)
+    {
+      int64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::high_resolution_clock::now() - start
+      )
+                         .count();
+
+      for (int i = 0; i < rootMovesCount; i++)
+        std::cout << Moves::getUCI(rootMoves[i]) << ": " << rootMoveCounts[i] << "\n";
+
+      std::cout << "\nNodes searched: " << nodes
+                << "\nTime: " << time << " ms"
+                << "\nNodes per second: " << nodes * 1000 / std::max<int64_t>(time, 1)
+                << std::endl;
+    }
+
+    return nodes;
+  }
+
+  uint64_t Perft::countNodes(Board& board, MoveStack& moveStack, int depth)
+  {
+    if (depth == 0)
+      return 1;
+
+    MoveAllocation legalMoves(moveStack);
+    int legalMovesCount = board.getLegalMoves(legalMoves);
+
+    // The moves themselves are the leaves, so there is no need to make them
+    if (depth == 1)
+      return legalMovesCount;
+
+    ZobristKey hashKey = getHashKey(board.zobristKey(), depth);
+
+    uint64_t nodes;
+    if (probe(hashKey, nodes))
+      return nodes;
+
+    nodes = 0;
+
+    for (int i = 0; i < legalMovesCount; i++)
+    {
+      Board::UnmoveData unmoveData = board.makeMove(legalMoves[i]);
+      nodes += countNodes(board, moveStack, depth - 1);
+      board.unmakeMove(legalMoves[i], unmoveData);
+    }
+
+    store(hashKey, nodes);
+
+    return nodes;
+  }
+
+  bool Perft::probe(ZobristKey hashKey, uint64_t& count) const
+  {
+    if (!ENTRY_COUNT)
+      return false;
+
+    const Entry& slot = entry(hashKey);
+
+    uint64_t keyXorCount = slot.keyXorCount.load(std::memory_order_relaxed);
+    count = slot.count.load(std::memory_order_relaxed);
+
+    return (keyXorCount ^ count) == hashKey && count != 0;
+  }
+
+  void Perft::store(ZobristKey hashKey, uint64_t count)
+  {
+    if (!ENTRY_COUNT)
+      return;
+
+    Entry& slot = entry(hashKey);
+
+    slot.keyXorCount.store(hashKey ^ count, std::memory_order_relaxed);
+    slot.count.store(count, std::memory_order_relaxed);
+  }
+}